@@ -242,6 +242,16 @@ const MqttSettingsForm: FC = () => {
                 />
               </Grid>
             )}
+            {!data.publish_single && (
+              <Grid item>
+                <BlockFormControlLabel
+                  control={
+                    <Checkbox name="publish_changed" checked={data.publish_changed} onChange={updateFormValue} />
+                  }
+                  label={LL.MQTT_PUBLISH_TEXT_6()}
+                />
+              </Grid>
+            )}
           </Grid>
         )}
         {!data.publish_single && (
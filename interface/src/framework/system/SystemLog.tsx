@@ -6,7 +6,7 @@ import { useState, useEffect, useRef } from 'react';
 import { toast } from 'react-toastify';
 import type { FC } from 'react';
 
-import type { LogSettings, LogEntry } from 'types';
+import type { LogSettings, LogEntry, LogBatch } from 'types';
 import { addAccessTokenParameter } from 'api/authentication';
 import { EVENT_SOURCE_ROOT } from 'api/endpoints';
 import * as SystemApi from 'api/system';
@@ -60,6 +60,8 @@ const SystemLog: FC = () => {
   useRequest(SystemApi.fetchLog());
   const [logEntries, setLogEntries] = useState<LogEntry[]>([]);
   const [lastIndex, setLastIndex] = useState<number>(0);
+  const [dropped, setDropped] = useState<number>(0);
+  const [pending, setPending] = useState<number>(0);
 
   const updateFormValue = updateValueDirty(origData, dirtyFlags, setDirtyFlags, updateDataValue);
 
@@ -94,10 +96,16 @@ const SystemLog: FC = () => {
   const onMessage = (event: MessageEvent) => {
     const rawData = event.data;
     if (typeof rawData === 'string' || rawData instanceof String) {
-      const logentry = JSON.parse(rawData as string) as LogEntry;
-      if (logentry.i > lastIndex) {
-        setLastIndex(logentry.i);
-        setLogEntries((log) => [...log, logentry]);
+      const parsed = JSON.parse(rawData as string) as LogEntry | LogBatch;
+      // a batch of entries, or a single entry
+      const entries = 'e' in parsed ? parsed.e.filter((e) => e.i > lastIndex) : parsed.i > lastIndex ? [parsed] : [];
+      if (entries.length) {
+        setLastIndex(entries[entries.length - 1].i);
+        setLogEntries((log) => [...log, ...entries]);
+      }
+      if ('e' in parsed) {
+        setDropped((d) => d + parsed.d);
+        setPending(parsed.p);
       }
     }
   };
@@ -225,6 +233,11 @@ const SystemLog: FC = () => {
               <span>{e.m}</span>
             </LogEntryLine>
           ))}
+          {(dropped > 0 || pending > 0) && (
+            <LogEntryLine sx={{ color: 'orange' }}>
+              ({dropped} dropped, {pending} waiting)
+            </LogEntryLine>
+          )}
           <div ref={ref} />
         </Box>
       </>
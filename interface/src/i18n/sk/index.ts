@@ -239,6 +239,7 @@ const sk: Translation = {
   MQTT_PUBLISH_TEXT_3: 'Povolenie zisťovania MQTT',
   MQTT_PUBLISH_TEXT_4: 'Predpona tém Discovery',
   MQTT_PUBLISH_TEXT_5: 'Typ zistenia',
+  MQTT_PUBLISH_TEXT_6: 'Only publish the values that have changed', // TODO translate
   MQTT_PUBLISH_INTERVALS: 'Intervaly zverejňovania',
   MQTT_INT_BOILER: 'Kotly a tepelné čerpadlá',
   MQTT_INT_THERMOSTATS: 'Termostaty',
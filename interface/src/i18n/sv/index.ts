@@ -239,6 +239,7 @@ const sv: Translation = {
   MQTT_PUBLISH_TEXT_3: 'Aktivera MQTT Discovery',
   MQTT_PUBLISH_TEXT_4: 'Prefix för  Discovery topics',
   MQTT_PUBLISH_TEXT_5: 'Discovery type', // TODO translate
+  MQTT_PUBLISH_TEXT_6: 'Only publish the values that have changed', // TODO translate
   MQTT_PUBLISH_INTERVALS: 'Publiceringsintervall',
   MQTT_INT_BOILER: 'Värmepump/panna',
   MQTT_INT_THERMOSTATS: 'Termostater',
@@ -46,6 +46,7 @@ export interface MqttSettings {
   send_response: boolean;
   publish_single: boolean;
   publish_single2cmd: boolean;
+  publish_changed: boolean;
   discovery_prefix: string;
   discovery_type: number;
 }
@@ -47,8 +47,16 @@ export interface LogEntry {
   m: string;
 }
 
+export interface LogBatch {
+  e: LogEntry[];
+  d: number;
+  p: number;
+}
+
 export interface LogSettings {
   level: number;
   max_messages: number;
   compact: false;
+  max_batch: number;
+  batch_bytes: number;
 }
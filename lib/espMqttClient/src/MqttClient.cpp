@@ -184,6 +184,26 @@ uint16_t MqttClient::publish(const char * topic, uint8_t qos, bool retain, espMq
     return packetId;
 }
 
+// added for EMS-ESP, writer fills the payload of the given length directly into the outbox packet
+uint16_t MqttClient::publish(const char * topic, uint8_t qos, bool retain, espMqttClientTypes::PayloadWriter writer, size_t length) {
+#if !EMC_ALLOW_NOT_CONNECTED_PUBLISH
+    if (_state != State::connected) {
+#else
+    if (_state > State::connected) {
+#endif
+        return 0;
+    }
+    EMC_SEMAPHORE_TAKE();
+    uint16_t packetId = (qos > 0) ? _getNextPacketId() : 1;
+    if (!_addPacket(packetId, topic, writer, length, qos, retain)) {
+        emc_log_e("Could not create PUBLISH packet");
+        _onError(packetId, Error::OUT_OF_MEMORY);
+        packetId = 0;
+    }
+    EMC_SEMAPHORE_GIVE();
+    return packetId;
+}
+
 void MqttClient::clearQueue(bool deleteSessionData) {
     _clearQueue(deleteSessionData ? 2 : 0);
 }
@@ -63,6 +63,7 @@ class MqttClient {
     uint16_t     publish(const char * topic, uint8_t qos, bool retain, const uint8_t * payload, size_t length);
     uint16_t     publish(const char * topic, uint8_t qos, bool retain, const char * payload);
     uint16_t     publish(const char * topic, uint8_t qos, bool retain, espMqttClientTypes::PayloadCallback callback, size_t length);
+    uint16_t     publish(const char * topic, uint8_t qos, bool retain, espMqttClientTypes::PayloadWriter writer, size_t length);
     void         clearQueue(bool deleteSessionData = false); // Not MQTT compliant and may cause unpredictable results when `deleteSessionData` = true!
     const char * getClientId() const;
     size_t       queueSize(); // No const because of mutex
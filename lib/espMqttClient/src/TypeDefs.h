@@ -63,6 +63,7 @@ typedef std::function<void(uint16_t packetId)> OnUnsubscribeCallback;
 typedef std::function<void(const MessageProperties& properties, const char* topic, const uint8_t* payload, size_t len, size_t index, size_t total)> OnMessageCallback;
 typedef std::function<void(uint16_t packetId)> OnPublishCallback;
 typedef std::function<size_t(uint8_t* data, size_t maxSize, size_t index)> PayloadCallback;
+typedef std::function<void(uint8_t* data, size_t length)> PayloadWriter;  // added for EMS-ESP, writes the whole payload in place
 typedef std::function<void(uint16_t packetId, Error error)> OnErrorCallback;
 
 enum class UseInternalTask {
@@ -51,6 +51,7 @@ void MqttSettingsService::startClient() {
         }
         static_cast<espMqttClientSecure *>(_mqttClient)->onConnect([this](bool sessionPresent) { onMqttConnect(sessionPresent); });
         static_cast<espMqttClientSecure *>(_mqttClient)->onDisconnect([this](espMqttClientTypes::DisconnectReason reason) { onMqttDisconnect(reason); });
+        static_cast<espMqttClientSecure *>(_mqttClient)->onPublish([](uint16_t packetId) { emsesp::EMSESP::mqtt_.on_publish(packetId); });
         static_cast<espMqttClientSecure *>(_mqttClient)
             ->onMessage(
                 [this](const espMqttClientTypes::MessageProperties & properties, const char * topic, const uint8_t * payload, size_t len, size_t index, size_t total) {
@@ -63,6 +64,7 @@ void MqttSettingsService::startClient() {
     _mqttClient = new espMqttClient(espMqttClientTypes::UseInternalTask::NO);
     static_cast<espMqttClient *>(_mqttClient)->onConnect([this](bool sessionPresent) { onMqttConnect(sessionPresent); });
     static_cast<espMqttClient *>(_mqttClient)->onDisconnect([this](espMqttClientTypes::DisconnectReason reason) { onMqttDisconnect(reason); });
+    static_cast<espMqttClient *>(_mqttClient)->onPublish([](uint16_t packetId) { emsesp::EMSESP::mqtt_.on_publish(packetId); });
     static_cast<espMqttClient *>(_mqttClient)
         ->onMessage(
             [this](const espMqttClientTypes::MessageProperties & properties, const char * topic, const uint8_t * payload, size_t len, size_t index, size_t total) {
@@ -238,6 +240,7 @@ void MqttSettings::read(MqttSettings & settings, JsonObject root) {
     root["discovery_type"]          = settings.discovery_type;
     root["publish_single"]          = settings.publish_single;
     root["publish_single2cmd"]      = settings.publish_single2cmd;
+    root["publish_changed"]         = settings.publish_changed;
     root["send_response"]           = settings.send_response;
 }
 
@@ -277,6 +280,7 @@ StateUpdateResult MqttSettings::update(JsonObject root, MqttSettings & settings)
     newSettings.discovery_type     = static_cast<uint8_t>(root["discovery_type"] | EMSESP_DEFAULT_DISCOVERY_TYPE);
     newSettings.publish_single     = root["publish_single"] | EMSESP_DEFAULT_PUBLISH_SINGLE;
     newSettings.publish_single2cmd = root["publish_single2cmd"] | EMSESP_DEFAULT_PUBLISH_SINGLE2CMD;
+    newSettings.publish_changed    = root["publish_changed"] | EMSESP_DEFAULT_PUBLISH_CHANGED;
     newSettings.send_response      = root["send_response"] | EMSESP_DEFAULT_SEND_RESPONSE;
     newSettings.entity_format      = static_cast<uint8_t>(root["entity_format"] | EMSESP_DEFAULT_ENTITY_FORMAT);
 
@@ -321,6 +325,10 @@ StateUpdateResult MqttSettings::update(JsonObject root, MqttSettings & settings)
         changed = true;
     }
 
+    if (newSettings.publish_changed != settings.publish_changed) {
+        changed = true;
+    }
+
     if (newSettings.send_response != settings.send_response) {
         changed = true;
     }
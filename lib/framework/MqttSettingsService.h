@@ -80,6 +80,7 @@ class MqttSettings {
     uint8_t  discovery_type;
     bool     publish_single;
     bool     publish_single2cmd;
+    bool     publish_changed;
     bool     send_response;
     uint8_t  entity_format;
 
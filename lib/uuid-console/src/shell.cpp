@@ -60,6 +60,8 @@ bool Shell::running() const {
 }
 
 void Shell::start() {
+    log_cursor_ = uuid::log::Logger::cursor_end(); // only show messages from now on
+
 #if defined(EMSESP_DEBUG)
     uuid::log::Logger::register_handler(this, uuid::log::Level::DEBUG); // added for EMS-ESP
 #else
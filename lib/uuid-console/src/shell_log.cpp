@@ -41,22 +41,6 @@ const uuid::log::Logger & Shell::logger() {
     return logger_instance;
 }
 
-Shell::QueuedLogMessage::QueuedLogMessage(unsigned long id, std::shared_ptr<uuid::log::Message> && content)
-    : id_(id)
-    , content_(std::move(content)) {
-}
-
-void Shell::operator<<(std::shared_ptr<uuid::log::Message> message) {
-#if UUID_CONSOLE_THREAD_SAFE
-    std::lock_guard<std::mutex> lock{mutex_};
-#endif
-    if (log_messages_.size() >= maximum_log_messages_) {
-        log_messages_.pop_front();
-    }
-
-    log_messages_.emplace_back(log_message_id_++, std::move(message));
-}
-
 uuid::log::Level Shell::log_level() const {
     return uuid::log::Logger::get_log_level(this);
 }
@@ -79,26 +63,27 @@ void Shell::maximum_log_messages(size_t count) {
 #endif
 
     maximum_log_messages_ = std::max((size_t)1, count);
-    while (log_messages_.size() > maximum_log_messages_) {
-        log_messages_.pop_front();
-    }
 }
 
 void Shell::output_logs() {
-#if UUID_CONSOLE_THREAD_SAFE
-    std::unique_lock<std::mutex> lock{mutex_};
-#endif
-
-    if (log_messages_.empty())
+    const uuid::log::Level level   = log_level();
+    const unsigned long    pending = uuid::log::Logger::pending(log_cursor_, level);
+    if (!pending) {
         return;
+    }
 
-    size_t count   = std::max((size_t)1, MAX_LOG_MESSAGES);
-    auto   message = log_messages_.front();
+    // skip the older messages if too many are waiting
+    const size_t maximum = maximum_log_messages();
+    if (pending > maximum) {
+        log_cursor_ = uuid::log::Logger::cursor_last(maximum, level);
+    }
 
-    log_messages_.pop_front();
-#if UUID_CONSOLE_THREAD_SAFE
-    lock.unlock();
-#endif
+    uuid::log::Record message;
+    if (!uuid::log::Logger::read(log_cursor_, level, message)) {
+        return;
+    }
+
+    size_t count = std::max((size_t)1, MAX_LOG_MESSAGES);
 
     if (mode_ != Mode::DELAY) {
         erase_current_line();
@@ -106,23 +91,23 @@ void Shell::output_logs() {
     }
 
     while (1) {
-        print(uuid::log::format_timestamp_ms(message.content_->uptime_ms, 3));
-        printf(" %c %lu: [%s] ", uuid::log::format_level_char(message.content_->level), message.id_, message.content_->name);
+        print(uuid::log::format_timestamp_ms(message.uptime_ms, 3));
+        printf(" %c %lu: [%s] ", uuid::log::format_level_char(message.level), message.id, message.name);
 
-        if ((message.content_->level == uuid::log::Level::ERR) || (message.content_->level == uuid::log::Level::WARNING)) {
+        if ((message.level == uuid::log::Level::ERR) || (message.level == uuid::log::Level::WARNING)) {
             print(COLOR_RED);
-            println(message.content_->text);
+            println(message.text);
             print(COLOR_RESET);
-        } else if (message.content_->level == uuid::log::Level::INFO) {
+        } else if (message.level == uuid::log::Level::INFO) {
             print(COLOR_YELLOW);
-            println(message.content_->text);
+            println(message.text);
             print(COLOR_RESET);
-        } else if (message.content_->level == uuid::log::Level::DEBUG) {
+        } else if (message.level == uuid::log::Level::DEBUG) {
             print(COLOR_CYAN);
-            println(message.content_->text);
+            println(message.text);
             print(COLOR_RESET);
         } else {
-            println(message.content_->text);
+            println(message.text);
         }
 
         ::yield();
@@ -132,21 +117,9 @@ void Shell::output_logs() {
             break;
         }
 
-#if UUID_CONSOLE_THREAD_SAFE
-        lock.lock();
-#endif
-        if (log_messages_.empty()) {
-#if UUID_CONSOLE_THREAD_SAFE
-            lock.unlock();
-#endif
+        if (!uuid::log::Logger::read(log_cursor_, level, message)) {
             break;
         }
-
-        message = log_messages_.front();
-        log_messages_.pop_front();
-#if UUID_CONSOLE_THREAD_SAFE
-        lock.unlock();
-#endif
     }
 
     display_prompt();
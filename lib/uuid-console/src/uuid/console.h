@@ -926,23 +926,9 @@ class Shell : public std::enable_shared_from_this<Shell>, public uuid::log::Hand
 	 * @since 0.1.0
 	 */
     static const uuid::log::Logger & logger();
-    /**
-	 * Add a new log message.
-	 *
-	 * This will be put in a queue for output at the next loop_one()
-	 * process. The queue has a maximum size of maximum_log_messages()
-	 * and will discard the oldest message first.
-	 *
-	 * @param[in] message New log message, shared by all handlers.
-	 * @since 0.1.0
-	 */
-    virtual void operator<<(std::shared_ptr<uuid::log::Message> message) override;
     /**
 	 * Get the current log level.
 	 *
-	 * This only affects newly received log messages, not messages that
-	 * have already been queued.
-	 *
 	 * @return The current log level.
 	 * @since 0.6.0
 	 */
@@ -950,8 +936,8 @@ class Shell : public std::enable_shared_from_this<Shell>, public uuid::log::Hand
     /**
 	 * Set the current log level.
 	 *
-	 * This only affects newly received log messages, not messages that
-	 * have already been queued.
+	 * This also applies to stored messages that have not been output
+	 * yet.
 	 *
 	 * @param[in] level Minimum log level that the shell will receive
 	 *                  messages for.
@@ -1502,31 +1488,6 @@ class Shell : public std::enable_shared_from_this<Shell>, public uuid::log::Hand
         bool              stop_              = false; /*!< There is a stop pending for the shell. @since 0.2.0 */
     };
 
-    /**
-	 * Log message that has been queued.
-	 *
-	 * Contains an identifier sequence to indicate when log messages
-	 * could not be output because the queue discarded one or more
-	 * messages.
-	 *
-	 * @since 0.1.0
-	 */
-    class QueuedLogMessage {
-      public:
-        /**
-		 * Create a queued log message.
-		 *
-		 * @param[in] id Identifier to use for the log message on the queue.
-		 * @param[in] content Log message content.
-		 * @since 0.1.0
-		 */
-        QueuedLogMessage(unsigned long id, std::shared_ptr<uuid::log::Message> && content);
-        ~QueuedLogMessage() = default;
-
-        unsigned long                             id_;      /*!< Sequential identifier for this log message. @since 0.1.0 */
-        std::shared_ptr<const uuid::log::Message> content_; /*!< Log message content. @since 0.1.0 */
-    };
-
     Shell(const Shell &)             = delete;
     Shell & operator=(const Shell &) = delete;
 
@@ -1648,11 +1609,10 @@ class Shell : public std::enable_shared_from_this<Shell>, public uuid::log::Hand
     std::deque<unsigned int>  context_;   /*!< Context stack for this shell. Affects which commands are available. Should never be empty. @since 0.1.0 */
     unsigned int              flags_ = 0; /*!< Current flags for this shell. Affects which commands are available. @since 0.1.0 */
 #if UUID_CONSOLE_THREAD_SAFE
-    mutable std::mutex mutex_; /*!< Mutex for queued log messages. @since 1.0.0 */
+    mutable std::mutex mutex_; /*!< Mutex for the log settings. @since 1.0.0 */
 #endif
-    unsigned long               log_message_id_ = 0;                      /*!< The next identifier to use for queued log messages. @since 0.1.0 */
-    std::list<QueuedLogMessage> log_messages_;                            /*!< Queued log messages, in the order they were received. @since 0.1.0 */
-    size_t                      maximum_log_messages_ = MAX_LOG_MESSAGES; /*!< Maximum command line length in bytes. @since 0.6.0 */
+    uuid::log::Cursor           log_cursor_;                              /*!< Read position in the log message store. */
+    size_t                      maximum_log_messages_ = MAX_LOG_MESSAGES; /*!< Maximum number of log messages waiting to be output. @since 0.6.0 */
     std::string                 line_buffer_; /*!< Command line buffer. Limited to maximum_command_line_length() bytes. @since 0.1.0 */
     size_t                      maximum_command_line_length_ = MAX_COMMAND_LINE_LENGTH; /*!< Maximum command line length in bytes. @since 0.6.0 */
     unsigned char               previous_  = 0; /*!< Previous character that was entered on the command line. Used to detect CRLF line endings. @since 0.1.0 */
@@ -53,14 +53,6 @@ static Level constrain_level(Level level) {
 }
 //! @endcond
 
-Message::Message(uint64_t uptime_ms, Level level, Facility facility, const char * name, const std::string && text)
-    : uptime_ms(uptime_ms)
-    , level(level)
-    , facility(facility)
-    , name(name)
-    , text(std::move(text)) {
-}
-
 Logger::Logger(const char * name, Facility facility)
     : name_(name)
     , facility_(facility){
@@ -232,28 +224,22 @@ void Logger::vlog(Level level, const char * format, va_list ap) const {
 }
 
 void Logger::vlog(Level level, Facility facility, const char * format, va_list ap) const {
-    std::vector<char> text(MAX_LOG_LENGTH + 1);
+    char text[MAX_LOG_LENGTH + 1];
 
-    if (vsnprintf(text.data(), text.size(), format, ap) <= 0) {
+    if (vsnprintf(text, sizeof(text), format, ap) <= 0) {
         return;
     }
 
     dispatch(level, facility, text);
 }
 
-void Logger::dispatch(Level level, Facility facility, std::vector<char> & text) const {
-    std::shared_ptr<Message> message = std::make_shared<Message>(get_uptime_ms(), level, facility, name_, text.data());
-    text.resize(0);
-
+void Logger::dispatch(Level level, Facility facility, const char * text) const {
 #if UUID_LOG_THREAD_SAFE
     std::lock_guard<std::mutex> lock{mutex_};
 #endif
 
-    for (auto & handler : *registered_handlers()) {
-        if (level <= handler.second) {
-            *handler.first << message;
-        }
-    }
+    // the handlers read it from the store through their own cursor
+    store(get_uptime_ms(), level, facility, name_, text);
 }
 
 /* Mutex already locked by caller. */
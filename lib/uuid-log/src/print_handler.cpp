@@ -47,34 +47,32 @@ void PrintHandler::maximum_log_messages(size_t count) {
 #endif
 
     maximum_log_messages_ = std::max((size_t)1, count);
-
-    while (log_messages_.size() > maximum_log_messages_) {
-        log_messages_.pop_front();
-    }
 }
 
 void PrintHandler::loop(size_t count) {
-#if UUID_LOG_THREAD_SAFE
-    std::unique_lock<std::mutex> lock{mutex_};
-#endif
+    const Level         level   = Logger::get_log_level(this);
+    const unsigned long pending = Logger::pending(log_cursor_, level);
+    if (!pending) {
+        return;
+    }
 
-    count = std::max((size_t)1, count);
+    const size_t maximum = maximum_log_messages();
+    if (pending > maximum) {
+        log_cursor_ = Logger::cursor_last(maximum, level);
+    }
 
-    while (!log_messages_.empty()) {
-        auto message = log_messages_.front();
+    Record message;
 
-        log_messages_.pop_front();
-#if UUID_LOG_THREAD_SAFE
-        lock.unlock();
-#endif
+    count = std::max((size_t)1, count);
 
-        print_.print(uuid::log::format_timestamp_ms(message->uptime_ms, 3).c_str());
+    while (Logger::read(log_cursor_, level, message)) {
+        print_.print(uuid::log::format_timestamp_ms(message.uptime_ms, 3).c_str());
         print_.print(' ');
-        print_.print(uuid::log::format_level_char(message->level));
+        print_.print(uuid::log::format_level_char(message.level));
         print_.print(" [");
-        print_.print(message->name);
+        print_.print(message.name);
         print_.print("] ");
-        print_.println(message->text.c_str());
+        print_.println(message.text);
 
         count--;
         if (count == 0) {
@@ -82,23 +80,7 @@ void PrintHandler::loop(size_t count) {
         }
 
         ::yield();
-
-#if UUID_LOG_THREAD_SAFE
-        lock.lock();
-#endif
-    }
-}
-
-void PrintHandler::operator<<(std::shared_ptr<Message> message) {
-#if UUID_LOG_THREAD_SAFE
-    std::lock_guard<std::mutex> lock{mutex_};
-#endif
-
-    if (log_messages_.size() >= maximum_log_messages_) {
-        log_messages_.pop_front();
     }
-
-    log_messages_.emplace_back(std::move(message));
 }
 
 } // namespace log
@@ -0,0 +1,266 @@
+/*
+ * uuid-log - Microcontroller logging framework
+ * Copyright 2019,2021-2022  Simon Arlott
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <uuid/log.h>
+
+#include <Arduino.h>
+
+#include <algorithm>
+#include <cstring>
+#if UUID_LOG_THREAD_SAFE
+#include <mutex>
+#endif
+
+namespace uuid {
+
+namespace log {
+
+//! @cond false
+// each message is stored as a header followed by the text without the terminator
+struct RingHeader {
+    uint64_t      uptime_ms;
+    const char *  name;
+    unsigned long id; // across both rings, to read them back in order
+    uint16_t      length;
+    Level         level;
+    Facility      facility;
+};
+
+static constexpr uint16_t RING_WRAP = UINT16_MAX; // length of the marker for "continue at the start"
+
+struct Ring {
+    char *        data;
+    size_t        size;
+    size_t        head;   // where the next message is written
+    size_t        tail;   // oldest stored message
+    unsigned long oldest; // sequence number of the message at tail
+    unsigned long next;   // sequence number of the next message, nothing is stored when equal to oldest
+};
+
+static_assert(Logger::DEBUG_RING_SIZE > 0 && Logger::DEBUG_RING_SIZE < Logger::RING_SIZE, "both rings need space");
+
+static char data_[Logger::RING_SIZE - Logger::DEBUG_RING_SIZE];
+static char debug_data_[Logger::DEBUG_RING_SIZE];
+
+static Ring rings_[2] = {{data_, sizeof(data_), 0, 0, 1, 1}, {debug_data_, sizeof(debug_data_), 0, 0, 1, 1}};
+
+static constexpr size_t DEBUG_RING = 1;
+
+static unsigned long next_id_ = 1;
+
+static RingHeader header_at(const Ring & ring, size_t offset) {
+    RingHeader header;
+    memcpy(&header, &ring.data[offset], sizeof(header));
+    return header;
+}
+
+// the message at offset, or at the start if the rest of the buffer is unused
+static size_t locate(const Ring & ring, size_t offset) {
+    if (ring.size - offset < sizeof(RingHeader) || header_at(ring, offset).length == RING_WRAP) {
+        return 0;
+    }
+    return offset;
+}
+
+// check if [from, to) overlaps the stored messages
+static bool in_use(const Ring & ring, size_t from, size_t to) {
+    if (from >= to || ring.oldest == ring.next) {
+        return false;
+    }
+    if (ring.tail < ring.head) {
+        return from < ring.head && ring.tail < to;
+    }
+    return ring.tail < to || from < ring.head; // wrapped, [tail, end) and [0, head)
+}
+
+static void evict(Ring & ring) {
+    ring.tail = locate(ring, ring.tail);
+    ring.tail += sizeof(RingHeader) + header_at(ring, ring.tail).length;
+    ring.oldest++;
+}
+
+// move the cursor to the next message up to a level, in the order they were logged
+// the debug ring is skipped for less verbose levels, its messages don't count as dropped
+static bool next(Cursor & cursor, Level level, RingHeader & header, const char *& text) {
+    size_t found = 0;
+    size_t start = 0;
+
+    for (size_t i = 0; i < 2; i++) {
+        Ring & ring = rings_[i];
+        if (i == DEBUG_RING && level < Level::DEBUG) {
+            cursor.id[i]     = ring.next;
+            cursor.offset[i] = ring.head;
+            continue;
+        }
+
+        // the position of the oldest message may have moved when the ones before it were removed
+        if (cursor.id[i] <= ring.oldest) {
+            if (cursor.id[i]) {
+                cursor.dropped += ring.oldest - cursor.id[i];
+            }
+            cursor.id[i]     = ring.oldest;
+            cursor.offset[i] = ring.tail;
+        }
+        if (cursor.id[i] >= ring.next) {
+            continue;
+        }
+
+        size_t     offset    = locate(ring, cursor.offset[i]);
+        RingHeader candidate = header_at(ring, offset);
+        if (!found || candidate.id < header.id) {
+            found  = i + 1;
+            start  = offset;
+            header = candidate;
+        }
+    }
+
+    if (!found) {
+        return false;
+    }
+
+    const Ring & ring        = rings_[found - 1];
+    cursor.offset[found - 1] = start + sizeof(header) + header.length;
+    cursor.id[found - 1]++;
+    text = &ring.data[start + sizeof(header)];
+    return true;
+}
+
+// the number of messages up to a level after the cursor
+static unsigned long count_pending(Cursor cursor, Level level) {
+    unsigned long count = 0;
+    RingHeader    header;
+    const char *  text;
+
+    while (next(cursor, level, header, text)) {
+        if (header.level <= level) {
+            count++;
+        }
+    }
+    return count;
+}
+//! @endcond
+
+/* Mutex already locked by caller. */
+void Logger::store(uint64_t uptime_ms, Level level, Facility facility, const char * name, const char * text) {
+    Ring & ring   = rings_[level >= Level::DEBUG ? DEBUG_RING : 0];
+    size_t length = std::min(strnlen(text, MAX_LOG_LENGTH), ring.size - sizeof(RingHeader));
+    size_t size   = sizeof(RingHeader) + length;
+    bool   wrap   = ring.size - ring.head < size;
+    size_t start  = wrap ? 0 : ring.head;
+
+    // make space by removing the oldest messages
+    while (wrap ? (in_use(ring, ring.head, ring.size) || in_use(ring, 0, size)) : in_use(ring, ring.head, ring.head + size)) {
+        evict(ring);
+    }
+
+    if (wrap && ring.size - ring.head >= sizeof(RingHeader)) {
+        RingHeader marker{};
+        marker.length = RING_WRAP;
+        memcpy(&ring.data[ring.head], &marker, sizeof(marker));
+    }
+    if (ring.oldest == ring.next) {
+        ring.tail = start;
+    }
+
+    RingHeader header{uptime_ms, name, next_id_++, (uint16_t)length, level, facility};
+    memcpy(&ring.data[start], &header, sizeof(header));
+    memcpy(&ring.data[start + sizeof(header)], text, length);
+    ring.head = start + size;
+    ring.next++;
+}
+
+bool Logger::read(Cursor & cursor, Level level, Record & record) {
+#if UUID_LOG_THREAD_SAFE
+    std::lock_guard<std::mutex> lock{mutex_};
+#endif
+
+    RingHeader   header;
+    const char * text;
+
+    while (next(cursor, level, header, text)) {
+        if (header.level > level) {
+            continue;
+        }
+
+        record.id        = header.id;
+        record.uptime_ms = header.uptime_ms;
+        record.level     = header.level;
+        record.facility  = header.facility;
+        record.name      = header.name;
+        memcpy(record.text, text, header.length);
+        record.text[header.length] = '\0';
+        return true;
+    }
+    return false;
+}
+
+Cursor Logger::cursor_end() {
+#if UUID_LOG_THREAD_SAFE
+    std::lock_guard<std::mutex> lock{mutex_};
+#endif
+
+    Cursor cursor;
+    for (size_t i = 0; i < 2; i++) {
+        cursor.id[i]     = rings_[i].next;
+        cursor.offset[i] = rings_[i].head;
+    }
+    return cursor;
+}
+
+Cursor Logger::cursor_last(size_t count, Level level) {
+#if UUID_LOG_THREAD_SAFE
+    std::lock_guard<std::mutex> lock{mutex_};
+#endif
+
+    Cursor        cursor;
+    unsigned long pending = count_pending(cursor, level);
+    RingHeader    header;
+    const char *  text;
+
+    // skip the oldest messages up to the level until count are left
+    while (pending > count && next(cursor, level, header, text)) {
+        if (header.level <= level) {
+            pending--;
+        }
+    }
+    return cursor;
+}
+
+unsigned long Logger::pending(const Cursor & cursor) {
+#if UUID_LOG_THREAD_SAFE
+    std::lock_guard<std::mutex> lock{mutex_};
+#endif
+
+    unsigned long pending = 0;
+    for (size_t i = 0; i < 2; i++) {
+        pending += rings_[i].next - std::max(cursor.id[i], rings_[i].oldest);
+    }
+    return pending;
+}
+
+unsigned long Logger::pending(const Cursor & cursor, Level level) {
+#if UUID_LOG_THREAD_SAFE
+    std::lock_guard<std::mutex> lock{mutex_};
+#endif
+
+    return count_pending(cursor, level);
+}
+
+} // namespace log
+
+} // namespace uuid
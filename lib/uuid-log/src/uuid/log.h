@@ -51,6 +51,14 @@
 #include <mutex>
 #endif
 
+#ifndef UUID_LOG_RING_SIZE
+#define UUID_LOG_RING_SIZE 8192
+#endif
+
+#ifndef UUID_LOG_DEBUG_RING_SIZE
+#define UUID_LOG_DEBUG_RING_SIZE (UUID_LOG_RING_SIZE / 2)
+#endif
+
 namespace uuid {
 
 /**
@@ -244,72 +252,31 @@ std::vector<std::string> levels_lowercase();
 bool parse_level_lowercase(const std::string & name, Level & level);
 
 /**
- * Log message text with timestamp and logger attributes.
+ * Read position of a log handler in the message store.
  *
- * These will be created when a message is logged and then passed to
- * all registered handlers.
- *
- * @since 1.0.0
+ * Log messages are stored once in fixed size ring buffers shared by
+ * all handlers, each handler reads them through its own cursor. DEBUG
+ * and TRACE messages have a ring of their own so that they can't push
+ * out the history of the less verbose levels. A default constructed
+ * cursor starts at the oldest stored message.
  */
-struct Message {
-    /**
-	 * Create a new log message (not directly useful).
-	 *
-	 * @param[in] uptime_ms System uptime, see uuid::get_uptime_ms().
-	 * @param[in] level Severity level of the message.
-	 * @param[in] facility Facility type of the process logging the message.
-	 * @param[in] name Logger name
-	 * @param[in] text Log message text.
-	 * @since 1.0.0
-	 */
-    Message(uint64_t uptime_ms, Level level, Facility facility, const char * name, const std::string && text);
-    ~Message() = default;
-
-    /**
-	 * System uptime at the time the message was logged.
-	 *
-	 * @see uuid::get_uptime_ms()
-	 * @since 1.0.0
-	 */
-    const uint64_t uptime_ms;
-
-    /**
-	 * Severity level of the message.
-	 *
-	 * @since 1.0.0
-	 */
-    const Level level;
-
-    /**
-	 * Facility type of the process that logged the message.
-	 *
-	 * @since 1.0.0
-	 */
-    const Facility facility;
-
-    /**
-	 * Name of the logger used
-	 *
-	 * @since 1.0.0
-	 */
-    const char * name;
-
-    /**
-	 * Formatted log message text.
-	 *
-	 * Does not include any of the other message attributes, those must
-	 * be added by the handler when outputting messages.
-	 *
-	 * @since 1.0.0
-	 */
-    const std::string text;
+struct Cursor {
+    unsigned long id[2]     = {0, 0}; /*!< Sequence number of the next message to read in each ring. */
+    size_t        offset[2] = {0, 0}; /*!< Position of that message in each ring. */
+    unsigned long dropped   = 0;      /*!< Number of messages overwritten before they were read. */
 };
 
+struct Record;
+
 class Logger;
 
 /**
  * Logger handler used to process log messages.
  *
+ * The registered level determines which messages are stored. Handlers
+ * read the messages from the store with Logger::read() when they are
+ * ready to output them.
+ *
  * @since 1.0.0
  */
 class Handler {
@@ -324,32 +291,6 @@ class Handler {
   public:
     virtual ~Handler();
 
-    /**
-	 * Add a new log message.
-	 *
-	 * This should normally be put in a queue instead of being
-	 * processed immediately so that log messages have minimal impact
-	 * at the time of use.
-	 *
-	 * Handlers must avoid holding a lock on a mutex used for adding
-	 * messages while processing those messages. Release the lock while
-	 * performing the processing.
-	 *
-	 * Queues should have a maximum size and discard the oldest message
-	 * when full.
-	 *
-	 * It is not safe for the handler to directly or indirectly do any
-	 * of the following while this function is being called:
-	 * - Log a message.
-	 * - Read the log level of any handler.
-	 * - Modify the log level of any handler.
-	 * - Unregister any handler.
-	 *
-	 * @param[in] message New log message, shared by all handlers.
-	 * @since 1.0.0
-	 */
-    virtual void operator<<(std::shared_ptr<Message> message) = 0;
-
   protected:
     Handler() = default;
 
@@ -382,6 +323,16 @@ class Logger {
 	 */
     static constexpr size_t MAX_LOG_LENGTH = 255;
 
+    /**
+	 * Size in bytes of the message store shared by all handlers.
+	 */
+    static constexpr size_t RING_SIZE = UUID_LOG_RING_SIZE;
+
+    /**
+	 * Part of RING_SIZE used for DEBUG and TRACE messages.
+	 */
+    static constexpr size_t DEBUG_RING_SIZE = UUID_LOG_DEBUG_RING_SIZE;
+
     /**
 	 * Create a new logger with the given name and logging facility.
 	 *
@@ -429,6 +380,55 @@ class Logger {
 	 */
     static Level get_log_level(const Handler * handler);
 
+    /**
+	 * Read the next stored message at or below a log level.
+	 *
+	 * Messages above the level are skipped. If the cursor has fallen
+	 * behind the oldest stored message, it continues from there and
+	 * the number of lost messages is added to Cursor::dropped.
+	 *
+	 * @param[in,out] cursor Read position of the handler.
+	 * @param[in] level Maximum level of the message to return.
+	 * @param[out] record Copy of the message.
+	 * @return True if a message was read, false if there are no more.
+	 */
+    static bool read(Cursor & cursor, Level level, Record & record);
+
+    /**
+	 * Get a cursor positioned after the newest stored message.
+	 *
+	 * @return Cursor that only reads messages logged from now on.
+	 */
+    static Cursor cursor_end();
+
+    /**
+	 * Get a cursor positioned at one of the last stored messages.
+	 *
+	 * @param[in] count Number of messages to go back.
+	 * @param[in] level Maximum level of the messages to count.
+	 * @return Cursor that reads at most the last count messages up to
+	 *         the level.
+	 */
+    static Cursor cursor_last(size_t count, Level level = Level::ALL);
+
+    /**
+	 * Get the number of stored messages not yet read through a cursor.
+	 *
+	 * @param[in] cursor Read position of the handler.
+	 * @return Number of messages of any level after the cursor.
+	 */
+    static unsigned long pending(const Cursor & cursor);
+
+    /**
+	 * Get the number of stored messages not yet read through a cursor,
+	 * up to a log level.
+	 *
+	 * @param[in] cursor Read position of the handler.
+	 * @param[in] level Maximum level of the messages to count.
+	 * @return Number of messages up to the level after the cursor.
+	 */
+    static unsigned long pending(const Cursor & cursor, Level level);
+
     /**
 	 * Get the current global log level.
 	 *
@@ -612,6 +612,18 @@ class Logger {
 	 */
     static std::shared_ptr<std::map<Handler *, Level>> & registered_handlers();
 
+    /**
+	 * Add a message to the store, removing the oldest messages to
+	 * make space. Mutex already locked by caller.
+	 *
+	 * @param[in] uptime_ms System uptime, see uuid::get_uptime_ms().
+	 * @param[in] level Severity level of the message.
+	 * @param[in] facility Facility type of the process logging the message.
+	 * @param[in] name Logger name.
+	 * @param[in] text Log message text.
+	 */
+    static void store(uint64_t uptime_ms, Level level, Facility facility, const char * name, const char * text);
+
     /**
 	 * Log a message at the specified level.
 	 *
@@ -634,8 +646,7 @@ class Logger {
     void vlog(Level level, Facility facility, const char * format, va_list ap) const;
 
     /**
-	 * Dispatch a log message to all handlers that are registered to
-	 * handle messages of the specified level.
+	 * Store a log message for all handlers.
 	 *
 	 * Automatically sets the timestamp of the message to the current
 	 * system uptime.
@@ -645,11 +656,11 @@ class Logger {
 	 * @param[in] text Log message text.
 	 * @since 1.0.0
 	 */
-    void dispatch(Level level, Facility facility, std::vector<char> & text) const;
+    void dispatch(Level level, Facility facility, const char * text) const;
 
     static std::atomic<Level> global_level_; /*!< Minimum global log level across all handlers. @since 3.0.0 */
 #if UUID_LOG_THREAD_SAFE
-    static std::mutex mutex_; /*!< Mutex for handlers. @since 2.3.0 */
+    static std::mutex mutex_; /*!< Mutex for handlers and the message store. @since 2.3.0 */
 #endif
 
     const char *   name_;                    /*!< Logger name */
@@ -657,6 +668,18 @@ class Logger {
     Level          local_level_{Level::ALL}; /*!< Logger level. @since 3.0.0 */
 };
 
+/**
+ * Log message copied out of the message store.
+ */
+struct Record {
+    unsigned long id;                               /*!< Sequential identifier of the message. */
+    uint64_t      uptime_ms;                        /*!< System uptime at the time the message was logged. */
+    Level         level;                            /*!< Severity level of the message. */
+    Facility      facility;                         /*!< Facility type of the process that logged the message. */
+    const char *  name;                             /*!< Name of the logger used. */
+    char          text[Logger::MAX_LOG_LENGTH + 1]; /*!< Formatted log message text. */
+};
+
 /**
  * Basic log handler for writing messages to any object supporting the
  * Print interface.
@@ -704,26 +727,13 @@ class PrintHandler : public uuid::log::Handler {
 	 */
     void loop(size_t count = SIZE_MAX);
 
-    /**
-	 * Add a new log message.
-	 *
-	 * This will be put in a queue for output at the next loop()
-	 * process. The queue has a maximum size of
-	 * get_maximum_log_messages() and will discard the oldest message
-	 * first.
-	 *
-	 * @param[in] message New log message, shared by all handlers.
-	 * @since 2.2.0
-	 */
-    virtual void operator<<(std::shared_ptr<Message> message);
-
   private:
     Print & print_; /*!< Destination for output of log messages. @since 2.2.0 */
 #if UUID_LOG_THREAD_SAFE
     mutable std::mutex mutex_; /*!< Mutex for configuration, state and queued log messages. @since 2.3.0 */
 #endif
-    size_t maximum_log_messages_ = MAX_LOG_MESSAGES;   /*!< Maximum number of log messages to buffer before they are output. @since 2.2.0 */
-    std::list<std::shared_ptr<Message>> log_messages_; /*!< Queued log messages, in the order they were received. @since 2.2.0 */
+    size_t maximum_log_messages_ = MAX_LOG_MESSAGES; /*!< Maximum number of log messages to buffer before they are output. @since 2.2.0 */
+    Cursor log_cursor_;                              /*!< Read position in the message store. */
 };
 
 } // namespace log
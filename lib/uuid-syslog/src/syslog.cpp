@@ -97,9 +97,11 @@ namespace uuid {
 namespace syslog {
 
 uuid::log::Logger SyslogService::logger_{__pstr__logger_name, uuid::log::Facility::SYSLOG};
-bool              SyslogService::QueuedLogMessage::time_good_ = false;
 
 void SyslogService::start() {
+    if (log_level() == uuid::log::Level::OFF) {
+        log_cursor_ = uuid::log::Logger::cursor_end();
+    }
     uuid::log::Logger::register_handler(this, uuid::log::Level::ALL);
 }
 
@@ -107,29 +109,10 @@ uuid::log::Level SyslogService::log_level() const {
     return uuid::log::Logger::get_log_level(this);
 }
 
-void SyslogService::remove_queued_messages(uuid::log::Level level) {
-#if UUID_SYSLOG_THREAD_SAFE
-    std::lock_guard<std::mutex> lock{mutex_};
-#endif
-    unsigned long offset = 0;
-
-    for (auto it = log_messages_.begin(); it != log_messages_.end();) {
-        if (it->content_->level > level) {
-            offset++;
-            it = log_messages_.erase(it);
-        } else {
-            it->id_ -= offset;
-            it++;
-        }
-    }
-
-    log_message_id_ -= offset;
-    log_message_fails_ += offset;
-}
-
 void SyslogService::log_level(uuid::log::Level level) {
-    if (!started_) {
-        remove_queued_messages(level);
+    // messages are filtered when they are read, skip the ones logged while switched off
+    if (level == uuid::log::Level::OFF || log_level() == uuid::log::Level::OFF) {
+        log_cursor_ = uuid::log::Logger::cursor_end();
     }
 
     // commented out for EMS-ESP
@@ -159,18 +142,10 @@ void SyslogService::maximum_log_messages(size_t count) {
     std::lock_guard<std::mutex> lock{mutex_};
 #endif
     maximum_log_messages_ = std::max((size_t)1, count);
-
-    while (log_messages_.size() > maximum_log_messages_) {
-        log_messages_.pop_front();
-    }
 }
 
 size_t SyslogService::current_log_messages() const {
-#if UUID_SYSLOG_THREAD_SAFE
-    std::lock_guard<std::mutex> lock{mutex_};
-#endif
-
-    return log_messages_.size();
+    return std::min((size_t)uuid::log::Logger::pending(log_cursor_, log_level()), maximum_log_messages());
 }
 
 std::pair<IPAddress, uint16_t> SyslogService::destination() const {
@@ -183,7 +158,6 @@ void SyslogService::destination(IPAddress ip, uint16_t port) {
 
     if ((uint32_t)ip_ == (uint32_t)0) {
         started_ = false;
-        remove_queued_messages(log_level());
         host_.clear();
     }
 }
@@ -191,8 +165,7 @@ void SyslogService::destination(IPAddress ip, uint16_t port) {
 void SyslogService::destination(const char * host, uint16_t port) {
     if (host == nullptr || host[0] == '\0') {
         started_ = false;
-        remove_queued_messages(log_level());
-        ip_ = (IPAddress)(uint32_t)0;
+        ip_      = (IPAddress)(uint32_t)0;
         host_.clear();
         return;
     }
@@ -202,7 +175,6 @@ void SyslogService::destination(const char * host, uint16_t port) {
         host_.clear();
         if ((uint32_t)ip_ == (uint32_t)0) {
             started_ = false;
-            remove_queued_messages(log_level());
         }
     } else {
         ip_ = (IPAddress)(uint32_t)0;
@@ -229,121 +201,68 @@ void SyslogService::mark_interval(unsigned long interval) {
     mark_interval_ = (uint64_t)interval * 1000;
 }
 
-SyslogService::QueuedLogMessage::QueuedLogMessage(unsigned long id, std::shared_ptr<uuid::log::Message> && content)
-    : id_(id)
-    , content_(std::move(content)) {
-    // Added for EMS-ESP
-    // check for Ethernet too. This assumes the network has already started.
-    if (time_good_ || emsesp::EMSESP::system_.network_connected()) {
-#if UUID_SYSLOG_HAVE_GETTIMEOFDAY
-        if (gettimeofday(&time_, nullptr) != 0) {
-            time_.tv_sec = (time_t)-1;
-        }
-#else
-        time_.tv_sec  = time(nullptr);
-        time_.tv_usec = 0;
-#endif
-        if (time_.tv_sec >= 0 && time_.tv_sec < 18140 * 86400) {
-            time_.tv_sec = (time_t)-1;
-        }
-
-        if (time_.tv_sec != (time_t)-1) {
-            time_good_ = true;
-        }
-    } else {
-        time_.tv_sec = (time_t)-1;
-    }
-}
-
-/* Mutex already locked by caller. */
-void SyslogService::add_message(std::shared_ptr<uuid::log::Message> & message) {
-    if (log_messages_.size() >= maximum_log_messages_) {
-        log_messages_.pop_front();
-        log_message_fails_++;
-    }
-
-    log_messages_.emplace_back(log_message_id_++, std::move(message));
-}
-
-void SyslogService::operator<<(std::shared_ptr<uuid::log::Message> message) {
-#if UUID_SYSLOG_THREAD_SAFE
-    std::lock_guard<std::mutex> lock{mutex_};
-#endif
-
-    add_message(message);
-}
-
 void SyslogService::loop() {
-#if UUID_SYSLOG_THREAD_SAFE
-    std::unique_lock<std::mutex> lock{mutex_};
-#endif
     size_t count = std::max((size_t)1, MAX_LOG_MESSAGES);
 
-    while (!log_messages_.empty()) {
-#if UUID_SYSLOG_THREAD_SAFE
-        lock.unlock();
-#endif
-
-        if (!can_transmit())
-            return;
-
-#if UUID_SYSLOG_THREAD_SAFE
-        lock.lock();
-
-        if (log_messages_.empty())
-            break;
-#endif
-
-        auto message = log_messages_.front();
+    // skip the older messages if too many are waiting
+    const uuid::log::Level level   = log_level();
+    const unsigned long    pending = uuid::log::Logger::pending(log_cursor_, level);
+    const size_t           maximum = maximum_log_messages();
+    if (pending > maximum) {
+        unsigned long dropped = log_cursor_.dropped;
+        log_cursor_           = uuid::log::Logger::cursor_last(maximum, level);
+        log_cursor_.dropped   = dropped;
+        log_message_fails_ += pending - maximum;
+    }
 
-        started_ = true;
+    if (pending) {
+        uuid::log::Record message;
 
-#if UUID_SYSLOG_THREAD_SAFE
-        lock.unlock();
-#endif
-
-        auto ok = transmit(message);
-        if (ok) {
-#if UUID_SYSLOG_THREAD_SAFE
-            lock.lock();
-#endif
+        while (1) {
+            // only move on when the message has been sent
+            uuid::log::Cursor next = log_cursor_;
+            if (!uuid::log::Logger::read(next, level, message)) {
+                log_cursor_ = next; // past the messages above the log level
+                break;
+            }
 
-            last_message_ = last_transmit_;
-            if (!log_messages_.empty() && log_messages_.front().content_ == message.content_) {
-                log_messages_.pop_front();
+            if (!can_transmit()) {
+                return;
             }
 
-#if UUID_SYSLOG_THREAD_SAFE
-            lock.unlock();
-#endif
-        }
+            started_ = true;
 
-        ::yield();
+            if (!transmit(message)) {
+                break;
+            }
 
-#if UUID_SYSLOG_THREAD_SAFE
-        lock.lock();
-#endif
+            log_cursor_   = next;
+            last_message_ = last_transmit_;
+            log_message_id_++;
 
-        if (!ok) {
-            break;
-        }
+            ::yield();
 
-        count--;
-        if (count == 0) {
-            break;
+            count--;
+            if (count == 0) {
+                break;
+            }
         }
     }
 
-    if (started_ && mark_interval_ != 0 && log_messages_.empty()) {
-        if (uuid::get_uptime_ms() - last_message_ >= mark_interval_) {
+    if (started_ && mark_interval_ != 0 && uuid::log::Logger::pending(log_cursor_, level) == 0) {
+        if (uuid::get_uptime_ms() - last_message_ >= mark_interval_ && can_transmit()) {
             // This is generated manually because the log level may not
             // be high enough to receive INFO messages.
-            auto message = std::make_shared<uuid::log::Message>(uuid::get_uptime_ms(),
-                                                                uuid::log::Level::INFO,
-                                                                uuid::log::Facility::SYSLOG,
-                                                                (__pstr__logger_name),
-                                                                "-- MARK --");
-            add_message(message);
+            uuid::log::Record mark;
+            mark.id        = log_message_id_;
+            mark.uptime_ms = uuid::get_uptime_ms();
+            mark.level     = uuid::log::Level::INFO;
+            mark.facility  = uuid::log::Facility::SYSLOG;
+            mark.name      = __pstr__logger_name;
+            strlcpy(mark.text, "-- MARK --", sizeof(mark.text));
+            if (transmit(mark)) {
+                last_message_ = last_transmit_;
+            }
         }
     }
 }
@@ -472,18 +391,37 @@ bool SyslogService::can_transmit() {
     return true;
 }
 
-bool SyslogService::transmit(const QueuedLogMessage & message) {
-    struct tm tm;
+bool SyslogService::transmit(const uuid::log::Record & message) {
+    struct tm      tm;
+    struct timeval time;
+
+#if UUID_SYSLOG_HAVE_GETTIMEOFDAY
+    if (gettimeofday(&time, nullptr) != 0) {
+        time.tv_sec = (time_t)-1;
+    }
+#else
+    time.tv_sec  = ::time(nullptr);
+    time.tv_usec = 0;
+#endif
+    if (time.tv_sec >= 0 && time.tv_sec < 18140 * 86400) {
+        time.tv_sec = (time_t)-1;
+    }
+    if (time.tv_sec != (time_t)-1) {
+        // the message was logged earlier, go back by its age
+        int64_t usec = (int64_t)time.tv_sec * 1000000 + time.tv_usec - (int64_t)(uuid::get_uptime_ms() - message.uptime_ms) * 1000;
+        time.tv_sec  = usec / 1000000;
+        time.tv_usec = usec % 1000000;
+    }
 
     // Changes for EMS-ESP
     int8_t tzh = 0;
     int8_t tzm = 0;
 
     tm.tm_year = 0;
-    if (message.time_.tv_sec != (time_t)-1) {
+    if (time.tv_sec != (time_t)-1) {
         struct tm utc;
-        gmtime_r(&message.time_.tv_sec, &utc);
-        localtime_r(&message.time_.tv_sec, &tm);
+        gmtime_r(&time.tv_sec, &utc);
+        localtime_r(&time.tv_sec, &tm);
         int16_t diff = 60 * (tm.tm_hour - utc.tm_hour) + tm.tm_min - utc.tm_min;
         diff         = diff > 720 ? diff - 1440 : diff < -720 ? diff + 1440 : diff;
 
@@ -513,7 +451,7 @@ bool SyslogService::transmit(const QueuedLogMessage & message) {
 	 * The maximum possible priority value does not exceed the requirement that
 	 * the PRI part MUST be 3-5 characters.
 	 */
-    udp_.printf("<%u>1 ", (uint8_t)(message.content_->facility * 8U) + std::min(7U, (unsigned int)message.content_->level));
+    udp_.printf("<%u>1 ", (uint8_t)(message.facility * 8U) + std::min(7U, (unsigned int)message.level));
 
     if (tm.tm_year != 0) {
         // udp_.printf_P("%04u-%02u-%02uT%02u:%02u:%02u.%06luZ",
@@ -533,19 +471,18 @@ bool SyslogService::transmit(const QueuedLogMessage & message) {
                     tm.tm_hour,
                     tm.tm_min,
                     tm.tm_sec,
-                    (unsigned long)message.time_.tv_usec,
+                    (unsigned long)time.tv_usec,
                     tzh,
                     tzm);
     } else {
         udp_.print('-');
     }
 
-    udp_.printf(" %s %s - - - ", hostname_.c_str(), message.content_->name);
+    udp_.printf(" %s %s - - - ", hostname_.c_str(), message.name);
 
     char id_c_str[15];
-    snprintf(id_c_str, sizeof(id_c_str), " %lu: ", message.id_);
-    std::string msgstr = uuid::log::format_timestamp_ms(message.content_->uptime_ms, 3) + ' ' + uuid::log::format_level_char(message.content_->level) + id_c_str
-                         + message.content_->text;
+    snprintf(id_c_str, sizeof(id_c_str), " %lu: ", message.id);
+    std::string msgstr = uuid::log::format_timestamp_ms(message.uptime_ms, 3) + ' ' + uuid::log::format_level_char(message.level) + id_c_str + message.text;
     for (uint16_t i = 0; i < msgstr.length(); i++) {
         if (msgstr.at(i) & 0x80) {
             udp_.print("\xEF\xBB\xBF");
@@ -97,9 +97,6 @@ class SyslogService : public uuid::log::Handler {
     /**
 	 * Get the current log level.
 	 *
-	 * This only affects newly received log messages, not messages that
-	 * have already been queued.
-	 *
 	 * @return The current log level.
 	 * @since 2.0.0
 	 */
@@ -107,9 +104,8 @@ class SyslogService : public uuid::log::Handler {
     /**
 	 * Set the current log level.
 	 *
-	 * Unless this is the first time the log level is being set, this
-	 * only affects newly received log messages, not messages that have
-	 * already been queued.
+	 * This also applies to stored messages that have not been sent yet.
+	 * Messages logged while the level was OFF are never sent.
 	 *
 	 * @param[in] level Minimum log level that will be sent to the
 	 *                  syslog server.
@@ -204,25 +200,12 @@ class SyslogService : public uuid::log::Handler {
 	 */
     void loop();
 
-    /**
-	 * Add a new log message.
-	 *
-	 * This will be put in a queue for output at the next loop()
-	 * process. The queue has a maximum size of
-	 * get_maximum_log_messages() and will discard the oldest message
-	 * first.
-	 *
-	 * @param[in] message New log message, shared by all handlers.
-	 * @since 1.0.0
-	 */
-    virtual void operator<<(std::shared_ptr<uuid::log::Message> message);
-
     /**
 	* added for EMS-ESP
 	* query status variables
     */
     size_t queued() {
-        return log_messages_.size();
+        return current_log_messages();
     }
     bool started() {
         return started_;
@@ -235,60 +218,10 @@ class SyslogService : public uuid::log::Handler {
         return log_message_id_;
     }
     unsigned long message_fails() {
-        return log_message_fails_;
+        return log_message_fails_ + log_cursor_.dropped;
     }
 
   private:
-    /**
-	 * Log message that has been queued.
-	 *
-	 * Contains an identifier sequence to indicate when log messages
-	 * could not be output because the queue discarded one or more
-	 * messages.
-	 *
-	 * @since 1.0.0
-	 */
-    class QueuedLogMessage {
-      public:
-        /**
-		 * Create a queued log message.
-		 *
-		 * @param[in] id Identifier to use for the log message on the queue.
-		 * @param[in] content Log message content.
-		 * @since 1.0.0
-		 */
-        QueuedLogMessage(unsigned long id, std::shared_ptr<uuid::log::Message> && content);
-        ~QueuedLogMessage() = default;
-
-        unsigned long                             id_;      /*!< Sequential identifier for this log message. @since 1.0.0 */
-        struct timeval                            time_;    /*!< Time message was received. @since 1.0.0 */
-        std::shared_ptr<const uuid::log::Message> content_; /*!< Log message content. @since 1.0.0 */
-
-      private:
-        static bool time_good_; /*!< System time appears to be valid. @since 1.0.0 */
-    };
-
-    /**
-	 * Add a new log message.
-	 *
-	 * This will be put in a queue for output at the next loop()
-	 * process. The queue has a maximum size of
-	 * get_maximum_log_messages() and will discard the oldest message
-	 * first.
-	 *
-	 * @param[in] message New log message, shared by all handlers.
-	 * @since 2.2.0
-	 */
-    void add_message(std::shared_ptr<uuid::log::Message> & message);
-
-    /**
-	 * Remove messages that were queued before the log level was set.
-	 *
-	 * @param[in] level New log level
-	 * @since 1.0.0
-	 */
-    void remove_queued_messages(uuid::log::Level level);
-
     /**
 	 * Check if it is possible to transmit to the server.
 	 *
@@ -306,7 +239,7 @@ class SyslogService : public uuid::log::Handler {
 	 *         false.
 	 * @since 1.0.0
 	 */
-    bool transmit(const QueuedLogMessage & message);
+    bool transmit(const uuid::log::Record & message);
 
     static uuid::log::Logger logger_; /*!< uuid::log::Logger instance for syslog services. @since 1.0.0 */
 
@@ -317,13 +250,13 @@ class SyslogService : public uuid::log::Handler {
     uint64_t    last_transmit_ = 0;            /*!< Last transmit time. @since 1.0.0 */
     std::string hostname_{'-'};                /*!< Local hostname. @since 1.0.0 */
 #if UUID_SYSLOG_THREAD_SAFE
-    mutable std::mutex mutex_; /*!< Mutex for queued log messages. @since 2.2.0 */
+    mutable std::mutex mutex_; /*!< Mutex for the log settings. @since 2.2.0 */
 #endif
-    size_t                      maximum_log_messages_ = MAX_LOG_MESSAGES; /*!< Maximum number of log messages to buffer before they are output. @since 1.0.0 */
-    unsigned long               log_message_id_       = 0;                /*!< The next identifier to use for queued log messages. @since 1.0.0 */
-    std::list<QueuedLogMessage> log_messages_;                            /*!< Queued log messages, in the order they were received. @since 1.0.0 */
-    uint64_t                    mark_interval_ = 0;                       /*!< Mark interval in milliseconds. @since 2.0.0 */
-    uint64_t                    last_message_  = 0;                       /*!< Last message/mark time. @since 2.0.0 */
+    size_t            maximum_log_messages_ = MAX_LOG_MESSAGES; /*!< Maximum number of log messages to buffer before they are output. @since 1.0.0 */
+    unsigned long     log_message_id_       = 0;                /*!< Number of log messages sent. @since 1.0.0 */
+    uuid::log::Cursor log_cursor_;                              /*!< Read position in the log message store. */
+    uint64_t          mark_interval_ = 0;                       /*!< Mark interval in milliseconds. @since 2.0.0 */
+    uint64_t          last_message_  = 0;                       /*!< Last message/mark time. @since 2.0.0 */
 
     // added by MichaelDvP for EMS-ESP
     IPAddress     ip_;   /*!< Host to send messages to. @since 1.0.0 */
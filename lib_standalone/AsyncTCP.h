@@ -14,6 +14,8 @@ class AsyncClient {
   public:
     AsyncClient(tcp_pcb * pcb = 0);
     ~AsyncClient();
+
+    void close(bool now = false){};
 };
 
 class AsyncServer {
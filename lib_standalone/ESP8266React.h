@@ -40,6 +40,7 @@ class DummySettings {
     String   base               = "ems-esp";
     bool     publish_single     = false;
     bool     publish_single2cmd = false;
+    bool     publish_changed    = false;
     bool     send_response      = false; // don't send response
     String   host               = "192.168.1.4";
     uint16_t port               = 1883;
@@ -61,6 +61,9 @@ typedef enum {
 
 typedef uint8_t                   WebRequestMethodComposite;
 typedef std::function<void(void)> ArDisconnectHandler;
+typedef std::function<size_t(uint8_t *, size_t, size_t)> AwsResponseFiller;
+
+#define RESPONSE_TRY_AGAIN 0xFFFFFFFF
 
 class AsyncWebServerRequest {
     friend class AsyncWebServer;
@@ -104,6 +107,12 @@ class AsyncWebServerRequest {
     void send(MsgpackAsyncJsonResponse * response){};
     void send(int code, const String & contentType = String(), const String & content = String()){};
     void send(int code, const String & contentType, const __FlashStringHelper *){};
+    void send(const String & contentType, size_t len, AwsResponseFiller callback){};
+    void sendChunked(const String & contentType, AwsResponseFiller callback) {
+        _filler = callback; // kept for the tests to pull the response
+    };
+
+    AwsResponseFiller _filler;
 
     const String & url() const {
         return _url;
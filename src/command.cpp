@@ -25,28 +25,28 @@ namespace emsesp {
 uuid::log::Logger Command::logger_{F_(command), uuid::log::Facility::DAEMON};
 
 std::vector<Command::CmdFunction> Command::cmdfunctions_;
+std::vector<Command::CmdIndex>    Command::cmd_index_;
 
 // takes a path and a json body, parses the data and calls the command
 // the path is leading so if duplicate keys are in the input JSON it will be ignored
 // the entry point will be either via the Web API (api/) or MQTT (<base>/)
 // returns a return code and json output
 uint8_t Command::process(const char * path, const bool is_admin, const JsonObject input, JsonObject output) {
-    SUrlParser p; // parse URL for the path names
+    PathParser p; // split the path into its folders
     p.parse(path);
 
-    if (!p.paths().size()) {
+    if (!p.size()) {
         return message(CommandRet::ERROR, "invalid path", output);
     }
 
     // check first if it's from API, if so strip the "api/"
-    if (p.paths().front() == "api") {
-        p.paths().erase(p.paths().begin());
+    if (p[0].equals("api")) {
+        p.remove_first();
     } else {
         // not /api, so must be MQTT path. Check for base and remove it.
-        if (!strncmp(path, Mqtt::base().c_str(), Mqtt::base().length())) {
-            char new_path[Mqtt::MQTT_TOPIC_MAX_SIZE];
-            strlcpy(new_path, path, sizeof(new_path));
-            p.parse(new_path + Mqtt::base().length() + 1); // re-parse the stripped path
+        const std::string & base = Mqtt::base();
+        if (!strncmp(path, base.c_str(), base.length())) {
+            p.parse(path + base.length()); // re-parse the stripped path
         } else {
             return message(CommandRet::ERROR, "unrecognized path", output); // error
         }
@@ -54,17 +54,17 @@ uint8_t Command::process(const char * path, const bool is_admin, const JsonObjec
 
     // re-calculate new path
     // if there is only a path (URL) and no body then error!
-    size_t num_paths = p.paths().size();
+    size_t num_paths = p.size();
     if (!num_paths && !input.size()) {
         return message(CommandRet::ERROR, "missing command in path", output);
     }
 
-    std::string cmd_s;
-    int8_t      id_n = -1; // default hc
+    int8_t id_n = -1; // default hc
 
     // check for a device as first item in the path
     // if its not a known device (thermostat, boiler etc) look for any special MQTT subscriptions
     const char * device_s = nullptr;
+    char         device_str[20];
     if (!num_paths) {
         // we must look for the device in the JSON body
         if (input.containsKey("device")) {
@@ -72,7 +72,7 @@ uint8_t Command::process(const char * path, const bool is_admin, const JsonObjec
         }
     } else {
         // extract it from the path
-        device_s = p.paths().front().c_str(); // get the device (boiler, thermostat, system etc)
+        device_s = p.join(device_str, sizeof(device_str), 0, 0); // get the device (boiler, thermostat, system etc)
     }
 
     // validate the device, make sure it exists
@@ -83,19 +83,11 @@ uint8_t Command::process(const char * path, const bool is_admin, const JsonObjec
     }
 
     // the next value on the path should be the command or entity name
+    // it could be in the format 'hc/XXX' or 'hc/XXX/attribute' so join them into one string
     const char * command_p = nullptr;
-    if (num_paths == 2) {
-        command_p = p.paths()[1].c_str();
-    } else if (num_paths == 3) {
-        // concatenate the path into one string as it could be in the format 'hc/XXX'
-        char command[COMMAND_MAX_LENGTH];
-        snprintf(command, sizeof(command), "%s/%s", p.paths()[1].c_str(), p.paths()[2].c_str());
-        command_p = command;
-    } else if (num_paths > 3) {
-        // concatenate the path into one string as it could be in the format 'hc/XXX/attribute'
-        char command[COMMAND_MAX_LENGTH];
-        snprintf(command, sizeof(command), "%s/%s/%s", p.paths()[1].c_str(), p.paths()[2].c_str(), p.paths()[3].c_str());
-        command_p = command;
+    char         command[COMMAND_MAX_LENGTH];
+    if (num_paths >= 2) {
+        command_p = p.join(command, sizeof(command), 1, num_paths > 3 ? 3 : num_paths - 1);
     } else {
         // take it from the JSON
         if (input.containsKey("entity")) {
@@ -389,6 +381,7 @@ void Command::add(const uint8_t device_type, const uint8_t device_id, const char
     }
 
     cmdfunctions_.emplace_back(device_type, device_id, flags, cmd, cb, nullptr, description); // callback for json is nullptr
+    add_index(device_type, cmd);
 }
 
 // add a command with no json output
@@ -405,11 +398,54 @@ void Command::add(const uint8_t device_type, const char * cmd, const cmd_json_fu
     }
 
     cmdfunctions_.emplace_back(device_type, 0, flags, cmd, nullptr, cb, description); // callback for json is included
+    add_index(device_type, cmd);
+}
+
+// FNV-1a hash of the device type and the lowercase command name
+uint32_t Command::cmd_hash(const uint8_t device_type, const char * cmd) {
+    uint32_t hash = (2166136261UL ^ device_type) * 16777619UL;
+    while (*cmd) {
+        hash = (hash ^ (uint8_t)tolower((unsigned char)*cmd++)) * 16777619UL;
+    }
+    return hash;
+}
+
+// adds the last registered command to the index
+void Command::add_index(const uint8_t device_type, const char * cmd) {
+    CmdIndex entry{cmd_hash(device_type, cmd), (uint16_t)(cmdfunctions_.size() - 1)};
+    auto     it = std::upper_bound(cmd_index_.begin(), cmd_index_.end(), entry, [](const CmdIndex & a, const CmdIndex & b) { return a.hash < b.hash; });
+    cmd_index_.insert(it, entry);
+}
+
+// returns the position in cmdfunctions_ of the first command added that matches, or -1 if not found
+// device_id 0 matches any device of that type
+int16_t Command::find_command_pos(const uint8_t device_type, const uint8_t device_id, const char * cmd) {
+    if ((cmd == nullptr) || (cmd[0] == '\0') || (cmdfunctions_.empty())) {
+        return -1;
+    }
+
+    uint32_t hash = cmd_hash(device_type, cmd);
+    auto     it   = std::lower_bound(cmd_index_.begin(), cmd_index_.end(), hash, [](const CmdIndex & entry, const uint32_t h) { return entry.hash < h; });
+    for (; it != cmd_index_.end() && it->hash == hash; it++) {
+        const auto & cf = cmdfunctions_[it->pos];
+        if ((cf.device_type_ == device_type) && (!device_id || cf.device_id_ == device_id) && !strcasecmp(cmd, cf.cmd_)) {
+            return it->pos;
+        }
+    }
+
+    return -1; // command not found
 }
 
 // see if a command exists for that device type
 // is not case sensitive
 Command::CmdFunction * Command::find_command(const uint8_t device_type, const uint8_t device_id, const char * cmd) {
+    int16_t pos = find_command_pos(device_type, device_id, cmd);
+    return pos < 0 ? nullptr : &cmdfunctions_[pos];
+}
+
+#if defined(EMSESP_STANDALONE)
+// the original lookup walking the full list, only used to compare with the index in the tests
+Command::CmdFunction * Command::find_command_scan(const uint8_t device_type, const uint8_t device_id, const char * cmd) {
     if ((cmd == nullptr) || (strlen(cmd) == 0) || (cmdfunctions_.empty())) {
         return nullptr;
     }
@@ -422,18 +458,25 @@ Command::CmdFunction * Command::find_command(const uint8_t device_type, const ui
 
     return nullptr; // command not found
 }
+#endif
 
 void Command::erase_command(const uint8_t device_type, const char * cmd) {
-    if ((cmd == nullptr) || (strlen(cmd) == 0) || (cmdfunctions_.empty())) {
+    int16_t pos = find_command_pos(device_type, 0, cmd);
+    if (pos < 0) {
         return;
     }
-    auto it = cmdfunctions_.begin();
-    for (auto & cf : cmdfunctions_) {
-        if (Helpers::toLower(cmd) == Helpers::toLower(cf.cmd_) && (cf.device_type_ == device_type)) {
-            cmdfunctions_.erase(it);
-            return;
+    cmdfunctions_.erase(cmdfunctions_.begin() + pos);
+
+    // remove from the index and shift the positions of the commands after it
+    for (auto it = cmd_index_.begin(); it != cmd_index_.end();) {
+        if (it->pos == pos) {
+            it = cmd_index_.erase(it);
+        } else {
+            if (it->pos > pos) {
+                it->pos--;
+            }
+            it++;
         }
-        it++;
     }
 }
 
@@ -650,6 +693,59 @@ void Command::show_all(uuid::console::Shell & shell) {
     shell.println();
 }
 
+// splits the path into folders, dropping any empty ones
+// returns false if there is nothing to parse
+bool PathParser::parse(const char * path) {
+    num_folders_ = 0;
+    if (path == nullptr) {
+        return false;
+    }
+
+    const char * c = path;
+    while (*c != '\0' && *c != '?') {
+        if (*c == '/') {
+            c++;
+            continue;
+        }
+        const char * start = c;
+        while (*c != '\0' && *c != '/' && *c != '?') {
+            c++;
+        }
+        if (num_folders_ < MAX_FOLDERS) {
+            folders_[num_folders_++] = {start, (uint8_t)std::min<size_t>(c - start, UINT8_MAX)};
+        }
+    }
+
+    return num_folders_ > 0;
+}
+
+void PathParser::remove_first() {
+    if (!num_folders_) {
+        return;
+    }
+    num_folders_--;
+    for (uint8_t i = 0; i < num_folders_; i++) {
+        folders_[i] = folders_[i + 1];
+    }
+}
+
+// copies the folders first to last into buf as a null terminated string, separated by '/'
+// the result is truncated to fit
+const char * PathParser::join(char * buf, size_t size, uint8_t first, uint8_t last) const {
+    size_t pos = 0;
+    for (uint8_t i = first; i <= last && i < num_folders_; i++) {
+        if (i > first && pos + 1 < size) {
+            buf[pos++] = '/';
+        }
+        size_t len = std::min<size_t>(folders_[i].len, size - 1 - pos);
+        memcpy(buf + pos, folders_[i].str, len);
+        pos += len;
+    }
+    buf[pos] = '\0';
+    return buf;
+}
+
+#if defined(EMSESP_STANDALONE)
 // Extract only the path component from the passed URI and normalized it
 // e.g. //one/two////three/// becomes /one/two/three
 std::string SUrlParser::path() {
@@ -734,4 +830,6 @@ bool SUrlParser::parse(const char * uri) {
     return true;
 }
 
+#endif
+
 } // namespace emsesp
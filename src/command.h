@@ -125,6 +125,9 @@ class Command {
 
     static void                   show_all(uuid::console::Shell & shell);
     static Command::CmdFunction * find_command(const uint8_t device_type, const uint8_t device_id, const char * cmd);
+#if defined(EMSESP_STANDALONE)
+    static Command::CmdFunction * find_command_scan(const uint8_t device_type, const uint8_t device_id, const char * cmd);
+#endif
 
     static void erase_command(const uint8_t device_type, const char * cmd);
     static void show(uuid::console::Shell & shell, uint8_t device_type, bool verbose);
@@ -144,6 +147,18 @@ class Command {
 
     static std::vector<CmdFunction> cmdfunctions_; // the list of commands
 
+    // index into cmdfunctions_, sorted by the hash of the device type and lowercase command name
+    // entries with the same hash are kept in the order they were added
+    struct CmdIndex {
+        uint32_t hash;
+        uint16_t pos; // position in cmdfunctions_
+    };
+    static std::vector<CmdIndex> cmd_index_;
+
+    static uint32_t cmd_hash(const uint8_t device_type, const char * cmd);
+    static void     add_index(const uint8_t device_type, const char * cmd);
+    static int16_t  find_command_pos(const uint8_t device_type, const uint8_t device_id, const char * cmd);
+
     inline static uint8_t message(uint8_t error_code, const char * message, const JsonObject output) {
         output.clear();
         output["message"] = message;
@@ -151,6 +166,44 @@ class Command {
     }
 };
 
+// splits a path like /api/thermostat/hc1/seltemp into its folders without copying or allocating memory
+// each folder points into the original string, which must stay in scope
+// empty folders are skipped and parsing stops at a '?' where the URL parameters start
+class PathParser {
+  public:
+    static constexpr uint8_t MAX_FOLDERS = 8;
+
+    struct Folder {
+        const char * str;
+        uint8_t      len;
+
+        bool equals(const char * s) const {
+            return !strncmp(str, s, len) && s[len] == '\0';
+        }
+    };
+
+    PathParser() = default;
+
+    bool parse(const char * path);
+
+    uint8_t size() const {
+        return num_folders_;
+    }
+
+    const Folder & operator[](uint8_t i) const {
+        return folders_[i];
+    }
+
+    void         remove_first();
+    const char * join(char * buf, size_t size, uint8_t first, uint8_t last) const;
+
+  private:
+    Folder  folders_[MAX_FOLDERS];
+    uint8_t num_folders_ = 0;
+};
+
+#if defined(EMSESP_STANDALONE)
+// the original parser, only used to compare with the PathParser in the tests
 class SUrlParser {
   private:
     std::unordered_map<std::string, std::string> m_keysvalues;
@@ -172,6 +225,7 @@ class SUrlParser {
 
     std::string path();
 };
+#endif
 
 } // namespace emsesp
 
@@ -23,17 +23,31 @@
 
 using uuid::log::Level;
 
+// highest log level compiled in, calls above it are removed by the compiler
+// e.g. -DEMSESP_LOG_LEVEL=uuid::log::Level::INFO or -DEMSESP_LOG_LEVEL=7
+#ifndef EMSESP_LOG_LEVEL
+#define EMSESP_LOG_LEVEL uuid::log::Level::ALL
+#endif
+
+// the arguments (like data_to_hex() or pretty_telegram()) are only evaluated if a log handler wants this level
+#define EMSESP_LOG(level, func, ...)                                                                                                                           \
+    do {                                                                                                                                                       \
+        if ((level) <= (EMSESP_LOG_LEVEL) && logger_.enabled(level)) {                                                                                         \
+            logger_.func(__VA_ARGS__);                                                                                                                         \
+        }                                                                                                                                                      \
+    } while (0)
+
 #if defined(EMSESP_DEBUG)
-#define LOG_DEBUG(...) logger_.debug(__VA_ARGS__)
+#define LOG_DEBUG(...) EMSESP_LOG(uuid::log::Level::DEBUG, debug, __VA_ARGS__)
 #else
 #define LOG_DEBUG(...)
 #endif
 
-#define LOG_INFO(...) logger_.info(__VA_ARGS__)
-#define LOG_TRACE(...) logger_.trace(__VA_ARGS__)
-#define LOG_NOTICE(...) logger_.notice(__VA_ARGS__)
-#define LOG_WARNING(...) logger_.warning(__VA_ARGS__)
-#define LOG_ERROR(...) logger_.err(__VA_ARGS__)
+#define LOG_INFO(...) EMSESP_LOG(uuid::log::Level::INFO, info, __VA_ARGS__)
+#define LOG_TRACE(...) EMSESP_LOG(uuid::log::Level::TRACE, trace, __VA_ARGS__)
+#define LOG_NOTICE(...) EMSESP_LOG(uuid::log::Level::NOTICE, notice, __VA_ARGS__)
+#define LOG_WARNING(...) EMSESP_LOG(uuid::log::Level::WARNING, warning, __VA_ARGS__)
+#define LOG_ERROR(...) EMSESP_LOG(uuid::log::Level::ERR, err, __VA_ARGS__)
 
 // flash strings
 using uuid::string_vector;
@@ -118,6 +118,10 @@ static void setup_commands(std::shared_ptr<Commands> & commands) {
                           string_vector{F_(show), F_(commands)},
                           [](Shell & shell, const std::vector<std::string> & arguments) { Command::show_all(shell); });
 
+    commands->add_command(ShellContext::MAIN, CommandFlags::USER, string_vector{F_(show), F_(perf)}, [](Shell & shell, const std::vector<std::string> & arguments) {
+        Perf::show(shell);
+    });
+
 
     //
     // System commands
@@ -185,6 +185,10 @@
 #define EMSESP_DEFAULT_PUBLISH_SINGLE2CMD false
 #endif
 
+#ifndef EMSESP_DEFAULT_PUBLISH_CHANGED
+#define EMSESP_DEFAULT_PUBLISH_CHANGED false
+#endif
+
 #ifndef EMSESP_DEFAULT_SEND_RESPONSE
 #define EMSESP_DEFAULT_SEND_RESPONSE false
 #endif
@@ -217,6 +221,34 @@
 #define EMSESP_DEFAULT_WEBLOG_COMPACT true
 #endif
 
+#ifndef EMSESP_DEFAULT_WEBLOG_BATCH
+#define EMSESP_DEFAULT_WEBLOG_BATCH 20 // max messages per event, 0 sends each message on its own
+#endif
+
+#ifndef EMSESP_DEFAULT_WEBLOG_BATCH_BYTES
+#define EMSESP_DEFAULT_WEBLOG_BATCH_BYTES 2048
+#endif
+
+#ifndef EMSESP_DEFAULT_TX_SHARE
+#define EMSESP_DEFAULT_TX_SHARE 100 // max % of the free bus time for our Tx and its replies, 100 is no limit
+#endif
+
+#ifndef EMSESP_DEFAULT_FETCH_MIN
+#define EMSESP_DEFAULT_FETCH_MIN 1 // fetch cycles (minutes) between fetches of a telegram with changing values
+#endif
+
+#ifndef EMSESP_DEFAULT_FETCH_MAX
+#define EMSESP_DEFAULT_FETCH_MAX 32 // fetch cycles (minutes) between fetches of a telegram that does not change
+#endif
+
+#ifndef EMSESP_DEFAULT_CAPTURE_SIZE
+#define EMSESP_DEFAULT_CAPTURE_SIZE 8192 // bytes of RAM for the bus capture, around 500 telegrams
+#endif
+
+#ifndef EMSESP_CAPTURE_FILE
+#define EMSESP_CAPTURE_FILE "/capture.bin"
+#endif
+
 #ifndef EMSESP_DEFAULT_ENTITY_FORMAT
 #define EMSESP_DEFAULT_ENTITY_FORMAT 1 // in MQTT discovery, use shortnames and not multiple (prefixed with base)
 #endif
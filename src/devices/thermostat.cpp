@@ -198,6 +198,8 @@ Thermostat::Thermostat(uint8_t device_type, uint8_t device_id, uint8_t product_i
         register_telegram_type(0x1D3, "JunkersDhw", true, MAKE_PF_CB(process_JunkersWW));
     }
 
+    build_hc_typeids();
+
     // register device values for common values (not heating circuit)
     register_device_values();
 
@@ -215,6 +217,36 @@ Thermostat::Thermostat(uint8_t device_type, uint8_t device_id, uint8_t product_i
     EMSESP::send_read_request(0xA2, device_id); // read errorCode (only published on errors)
 }
 
+// merge the hc type_id lists into one sorted lookup
+// the lists are added in the order heating_circuit() used to search them, the first match for a type_id wins
+void Thermostat::build_hc_typeids() {
+    const std::vector<uint16_t> * lists[] = {&monitor_typeids,
+                                             &set_typeids,
+                                             &set2_typeids,
+                                             &summer_typeids,
+                                             &summer2_typeids,
+                                             &curve_typeids,
+                                             &timer_typeids,
+                                             &timer2_typeids,
+                                             &hp_typeids,
+                                             &hpmode_typeids};
+
+    hc_typeids_.clear();
+    for (auto list : lists) {
+        for (uint8_t i = 0; i < list->size(); i++) {
+            uint16_t type_id = (*list)[i];
+            auto     it = std::lower_bound(hc_typeids_.begin(), hc_typeids_.end(), type_id, [](const HcTypeId & h, const uint16_t id) {
+                return h.type_id < id;
+            });
+            if (type_id == 0 || (it != hc_typeids_.end() && it->type_id == type_id)) {
+                continue; // not used or already taken by an earlier list
+            }
+            hc_typeids_.insert(it, {type_id, (uint8_t)(i + 1), list == &monitor_typeids});
+        }
+    }
+    hc_typeids_.shrink_to_fit();
+}
+
 // returns the heating circuit object based on the hc number
 // of nullptr if it doesn't exist yet
 std::shared_ptr<Thermostat::HeatingCircuit> Thermostat::heating_circuit(const uint8_t hc_num) {
@@ -252,102 +284,14 @@ std::shared_ptr<Thermostat::HeatingCircuit> Thermostat::heating_circuit(std::sha
         toggle_ = true;
     }
 
-    // not found, search monitor message types
-    if (hc_num == 0) {
-        for (uint8_t i = 0; i < monitor_typeids.size(); i++) {
-            if (monitor_typeids[i] == telegram->type_id) {
-                hc_num  = i + 1;
-                toggle_ = true;
-                break;
-            }
-        }
-    }
-    // not found, search status message/set types
-    if (hc_num == 0) {
-        for (uint8_t i = 0; i < set_typeids.size(); i++) {
-            if (set_typeids[i] == telegram->type_id) {
-                hc_num = i + 1;
-                break;
-            }
-        }
-    }
-
-    // not found, search set2 types
-    if (hc_num == 0) {
-        for (uint8_t i = 0; i < set2_typeids.size(); i++) {
-            if (set2_typeids[i] == telegram->type_id) {
-                hc_num = i + 1;
-                break;
-            }
-        }
-    }
-
-    // not found, search summer message types
-    if (hc_num == 0) {
-        for (uint8_t i = 0; i < summer_typeids.size(); i++) {
-            if (summer_typeids[i] == telegram->type_id) {
-                hc_num = i + 1;
-                break;
-            }
-        }
-    }
-
-    // not found, search summer message types
+    // not found, search the monitor, set, summer, curve, timer and heatpump message types
     if (hc_num == 0) {
-        for (uint8_t i = 0; i < summer2_typeids.size(); i++) {
-            if (summer2_typeids[i] == telegram->type_id) {
-                hc_num = i + 1;
-                break;
-            }
-        }
-    }
-
-    // not found, search heating_curve message types
-    if (hc_num == 0) {
-        for (uint8_t i = 0; i < curve_typeids.size(); i++) {
-            if (curve_typeids[i] == telegram->type_id) {
-                hc_num = i + 1;
-                break;
-            }
-        }
-    }
-
-    // not found, search timer message types
-    if (hc_num == 0) {
-        for (uint8_t i = 0; i < timer_typeids.size(); i++) {
-            if (timer_typeids[i] == telegram->type_id) {
-                hc_num = i + 1;
-                break;
-            }
-        }
-    }
-
-    // not found, search timer message types
-    if (hc_num == 0) {
-        for (uint8_t i = 0; i < timer2_typeids.size(); i++) {
-            if (timer2_typeids[i] == telegram->type_id) {
-                hc_num = i + 1;
-                break;
-            }
-        }
-    }
-
-    // not found, search heatpump message types
-    if (hc_num == 0) {
-        for (uint8_t i = 0; i < hp_typeids.size(); i++) {
-            if (hp_typeids[i] == telegram->type_id) {
-                hc_num = i + 1;
-                break;
-            }
-        }
-    }
-
-    if (hc_num == 0) {
-        for (uint8_t i = 0; i < hpmode_typeids.size(); i++) {
-            if (hpmode_typeids[i] == telegram->type_id) {
-                hc_num = i + 1;
-                break;
-            }
+        auto it = std::lower_bound(hc_typeids_.begin(), hc_typeids_.end(), telegram->type_id, [](const HcTypeId & h, const uint16_t id) {
+            return h.type_id < id;
+        });
+        if (it != hc_typeids_.end() && it->type_id == telegram->type_id) {
+            hc_num  = it->hc_num;
+            toggle_ = it->toggle;
         }
     }
 
@@ -188,6 +188,14 @@ class Thermostat : public EMSdevice {
     std::vector<uint16_t> hp_typeids;
     std::vector<uint16_t> hpmode_typeids;
 
+    // all of the above merged and sorted by type_id, built once in the constructor
+    struct HcTypeId {
+        uint16_t type_id;
+        uint8_t  hc_num;
+        bool     toggle; // monitor telegram, can register a new heating circuit
+    };
+    std::vector<HcTypeId> hc_typeids_;
+
     // standard for all thermostats
     char     status_[20];    // online or offline
     char     dateTime_[25];  // date and time stamp
@@ -355,6 +363,7 @@ class Thermostat : public EMSdevice {
     static constexpr uint8_t EMS_TYPE_RC30wwSettings = 0x3A; // RC30 ww settings
     static constexpr uint8_t EMS_TYPE_time           = 0x06; // time
 
+    void                                        build_hc_typeids();
     std::shared_ptr<Thermostat::HeatingCircuit> heating_circuit(std::shared_ptr<const Telegram> telegram);
     std::shared_ptr<Thermostat::HeatingCircuit> heating_circuit(const uint8_t hc_num);
 
@@ -21,6 +21,10 @@
 
 namespace emsesp {
 
+uint8_t  EMSdevice::fetch_min_     = EMSESP_DEFAULT_FETCH_MIN;
+uint8_t  EMSdevice::fetch_max_     = EMSESP_DEFAULT_FETCH_MAX;
+uint32_t EMSdevice::fetch_skipped_ = 0;
+
 // returns number of visible device values (entries) for this device
 // this includes commands since they can also be entities and visible in the web UI
 uint8_t EMSdevice::count_entities() {
@@ -42,7 +46,7 @@ bool EMSdevice::has_entities() const {
     }
     bool found = false;
     EMSESP::webCustomizationService.read([&](WebCustomization & settings) {
-        for (EntityCustomization entityCustomization : settings.entityCustomizations) {
+        for (const EntityCustomization & entityCustomization : settings.entityCustomizations) {
             if (entityCustomization.device_id == device_id() && entityCustomization.entity_ids.size()) {
                 found = true;
                 break;
@@ -298,15 +302,33 @@ const std::string EMSdevice::to_string_short() {
 }
 
 // for each telegram that has the fetch value set (true) do a read request
-void EMSdevice::fetch_values() {
+// a scheduled fetch doubles the interval of a telegram each time its values have not changed, up to fetch_max_,
+// and goes back to fetch_min_ when a value changes
+void EMSdevice::fetch_values(const bool scheduled) {
 #if defined(EMSESP_DEBUG)
     EMSESP::logger().debug("Fetching values for deviceID 0x%02X", device_id());
 #endif
 
-    for (const auto & tf : telegram_functions_) {
-        if (tf.fetch_) {
-            read_command(tf.telegram_type_id_);
+    for (auto & tf : telegram_functions_) {
+        if (!tf.fetch_) {
+            continue;
         }
+        if (scheduled) {
+            if (tf.changed_) {
+                tf.fetch_interval_ = fetch_min_;
+                tf.fetch_wait_     = std::min(tf.fetch_wait_, (uint8_t)(fetch_min_ - 1));
+            }
+            if (tf.fetch_wait_) {
+                tf.fetch_wait_--;
+                fetch_skipped_++;
+                continue;
+            }
+            uint16_t interval  = (!tf.changed_ && tf.received_) ? tf.fetch_interval_ * 2 : tf.fetch_interval_;
+            tf.fetch_interval_ = std::max(std::min(interval, (uint16_t)fetch_max_), (uint16_t)fetch_min_);
+            tf.fetch_wait_     = tf.fetch_interval_ - 1;
+            tf.changed_        = false;
+        }
+        read_command(tf.telegram_type_id_);
     }
 }
 
@@ -325,22 +347,14 @@ void EMSdevice::toggle_fetch(uint16_t telegram_id, bool toggle) {
 
 // get status of automatic fetch for a telegramID
 bool EMSdevice::is_fetch(uint16_t telegram_id) const {
-    for (const auto & tf : telegram_functions_) {
-        if (tf.telegram_type_id_ == telegram_id) {
-            return tf.fetch_;
-        }
-    }
-    return false;
+    auto pos = find_telegram_function(telegram_id);
+    return pos >= 0 && telegram_functions_[pos].fetch_;
 }
 
 // get receive status of telegramID
 bool EMSdevice::is_received(uint16_t telegram_id) const {
-    for (const auto & tf : telegram_functions_) {
-        if (tf.telegram_type_id_ == telegram_id) {
-            return tf.received_;
-        }
-    }
-    return false;
+    auto pos = find_telegram_function(telegram_id);
+    return pos >= 0 && telegram_functions_[pos].received_;
 }
 
 // check for a tag to create a nest
@@ -485,6 +499,23 @@ void EMSdevice::show_mqtt_handlers(uuid::console::Shell & shell) const {
 // register a callback function for a specific telegram type
 void EMSdevice::register_telegram_type(const uint16_t telegram_type_id, const char * telegram_type_name, bool fetch, const process_function_p f) {
     telegram_functions_.emplace_back(telegram_type_id, telegram_type_name, fetch, false, f);
+
+    // add to the sorted index, after any existing entries with the same type_id
+    auto it = std::upper_bound(telegram_index_.begin(), telegram_index_.end(), telegram_type_id, [](const uint16_t id, const TelegramIndex & ti) {
+        return id < ti.type_id;
+    });
+    telegram_index_.insert(it, {telegram_type_id, (uint16_t)(telegram_functions_.size() - 1)});
+}
+
+// find the first registered handler for a telegram_type_id, returns its position in telegram_functions_ or -1
+int16_t EMSdevice::find_telegram_function(const uint16_t telegram_type_id) const {
+    auto it = std::lower_bound(telegram_index_.begin(), telegram_index_.end(), telegram_type_id, [](const TelegramIndex & ti, const uint16_t id) {
+        return ti.type_id < id;
+    });
+    if (it == telegram_index_.end() || it->type_id != telegram_type_id) {
+        return -1;
+    }
+    return it->pos;
 }
 
 // add to device value library, also know now as a "device entity"
@@ -535,37 +566,29 @@ void EMSdevice::add_device_value(uint8_t               tag,              // to b
         fullname = &name[1]; // translations start at index 1
     }
 
-    // scan through customizations to see if it's on the exclusion list by matching the productID and deviceID
+    // look up the customizations to see if it's on the exclusion list by matching the productID and deviceID
     EMSESP::webCustomizationService.read([&](WebCustomization & settings) {
-        for (EntityCustomization entityCustomization : settings.entityCustomizations) {
+        for (const EntityCustomization & entityCustomization : settings.entityCustomizations) {
             if ((entityCustomization.product_id == product_id()) && (entityCustomization.device_id == device_id())) {
                 char entity[70];
                 if (tag < DeviceValueTAG::TAG_HC1) {
-                    strncpy(entity, short_name, sizeof(entity));
+                    strlcpy(entity, short_name, sizeof(entity));
                 } else {
                     snprintf(entity, sizeof(entity), "%s/%s", tag_to_mqtt(tag), short_name);
                 }
 
-                for (std::string entity_id : entityCustomization.entity_ids) {
-                    // if there is an appended custom name, strip it to get the true entity name
-                    // and extract the new custom name
-                    auto        custom_name_pos = entity_id.find('|');
-                    bool        has_custom_name = (custom_name_pos != std::string::npos);
-                    std::string shortname       = has_custom_name ? entity_id.substr(2, custom_name_pos - 2) : entity_id.substr(2);
-
-                    // we found the device entity
-                    if (shortname == entity) {
-                        // get Mask
-                        uint8_t mask = Helpers::hextoint(entity_id.substr(0, 2).c_str());
-                        state        = mask << 4;             // set state high bits to flag, turn off active and ha flags
-                        ignore       = (mask & 0x80) == 0x80; // do not register
-                        // see if there is a custom name in the entity string
-                        if (has_custom_name) {
-                            custom_fullname = entity_id.substr(custom_name_pos + 1);
-                        }
-                        break;
+                // we found the device entity
+                auto found = entityCustomization.find_entity(entity);
+                if (found) {
+                    state  = found->mask << 4;             // set state high bits to flag, turn off active and ha flags
+                    ignore = (found->mask & 0x80) == 0x80; // do not register
+                    // see if there is a custom name in the entity string
+                    auto custom_name = entityCustomization.custom_name(*found);
+                    if (custom_name) {
+                        custom_fullname = custom_name;
                     }
                 }
+                break;
             }
         }
     });
@@ -578,6 +601,12 @@ void EMSdevice::add_device_value(uint8_t               tag,              // to b
     devicevalues_.emplace_back(
         device_type_, tag, value_p, type, options, options_single, numeric_operator, short_name, fullname, custom_fullname, uom, has_cmd, min, max, state);
 
+    // add to the sorted value index, after any existing entries with the same value_p
+    auto it = std::upper_bound(value_index_.begin(), value_index_.end(), (const void *)value_p, [](const void * p, const ValueIndex & vi) {
+        return std::less<const void *>()(p, vi.value_p);
+    });
+    value_index_.insert(it, {value_p, (uint16_t)(devicevalues_.size() - 1)});
+
     // add a new command if it has a function attached
     if (has_cmd) {
         uint8_t flags = CommandFlag::ADMIN_ONLY; // executing commands require admin privileges
@@ -735,6 +764,29 @@ void EMSdevice::set_minmax(const void * value_p, int16_t min, uint32_t max) {
     }
 }
 
+// called from the has_update() helpers when a value has changed
+// flag it for the next changed-only publish, and publish it if we're using single topics
+void EMSdevice::value_changed(void * value_p) {
+    if (Mqtt::publish_changed()) {
+        auto pos = find_device_value(value_p);
+        if (pos >= 0) {
+            devicevalues_[pos].add_state(DeviceValueState::DV_CHANGED);
+        }
+    }
+    publish_value(value_p);
+}
+
+// find the first registered device value for a value_p, returns its position in devicevalues_ or -1
+int16_t EMSdevice::find_device_value(const void * value_p) const {
+    auto it = std::lower_bound(value_index_.begin(), value_index_.end(), value_p, [](const ValueIndex & vi, const void * p) {
+        return std::less<const void *>()(vi.value_p, p);
+    });
+    if (it == value_index_.end() || it->value_p != value_p) {
+        return -1;
+    }
+    return it->pos;
+}
+
 // publish a single value on change
 void EMSdevice::publish_value(void * value_p) const {
     if (!Mqtt::publish_single() || value_p == nullptr) {
@@ -1074,13 +1126,13 @@ void EMSdevice::generate_values_web_customization(JsonArray output) {
     }
 
     EMSESP::webCustomizationService.read([&](WebCustomization & settings) {
-        for (EntityCustomization entityCustomization : settings.entityCustomizations) {
+        for (const EntityCustomization & entityCustomization : settings.entityCustomizations) {
             if (entityCustomization.device_id == device_id()) {
-                for (std::string entity_id : entityCustomization.entity_ids) {
-                    uint8_t mask = Helpers::hextoint(entity_id.substr(0, 2).c_str());
+                for (const auto & entity_id : entityCustomization.entity_ids) {
+                    uint8_t mask = EntityCustomization::entity_mask(entity_id);
                     if (mask & 0x80) {
                         JsonObject obj = output.add<JsonObject>();
-                        obj["id"]      = DeviceValue::get_name(entity_id);
+                        obj["id"]      = entity_id.substr(2, EntityCustomization::name_length(entity_id));
                         obj["m"]       = mask;
                         obj["w"]       = false;
                     }
@@ -1107,23 +1159,23 @@ void EMSdevice::set_climate_minmax(uint8_t tag, int16_t min, uint32_t max) {
 // set mask per device entity based on the id which is prefixed with the 2 char hex mask value
 // returns true if the entity has a mask set (not 0 the default)
 void EMSdevice::setCustomizationEntity(const std::string & entity_id) {
+    // extract the shortname
+    uint8_t      name_len        = EntityCustomization::name_length(entity_id);
+    const char * shortname       = entity_id.c_str() + 2;
+    bool         has_custom_name = entity_id.size() > name_len + 2u;
+
     for (auto & dv : devicevalues_) {
         char entity_name[70];
         if (dv.tag < DeviceValueTAG::TAG_HC1) {
-            strncpy(entity_name, dv.short_name, sizeof(entity_name));
+            strlcpy(entity_name, dv.short_name, sizeof(entity_name));
         } else {
             snprintf(entity_name, sizeof(entity_name), "%s/%s", tag_to_mqtt(dv.tag), dv.short_name);
         }
 
-        // extra shortname
-        auto        custom_name_pos = entity_id.find('|');
-        bool        has_custom_name = (custom_name_pos != std::string::npos);
-        std::string shortname       = has_custom_name ? entity_id.substr(2, custom_name_pos - 2) : entity_id.substr(2);
-
-        if (entity_name == shortname) {
+        if (!strncmp(entity_name, shortname, name_len) && entity_name[name_len] == '\0') {
             // check the masks
             uint8_t current_mask = dv.state >> 4;
-            uint8_t new_mask     = Helpers::hextoint(entity_id.substr(0, 2).c_str()); // first character contains mask flags
+            uint8_t new_mask     = EntityCustomization::entity_mask(entity_id); // first character contains mask flags
 
             // if it's a new mask, reconfigure HA
             if (Mqtt::ha_enabled() && (has_custom_name || ((current_mask ^ new_mask) & (DeviceValueState::DV_READONLY >> 4)))) {
@@ -1136,11 +1188,7 @@ void EMSdevice::setCustomizationEntity(const std::string & entity_id) {
             dv.state = ((dv.state & 0x0F) | (new_mask << 4)); // set state high bits to flag
 
             // set the custom name if it has one, or clear it
-            if (has_custom_name) {
-                dv.custom_fullname = entity_id.substr(custom_name_pos + 1);
-            } else {
-                dv.custom_fullname = "";
-            }
+            dv.set_custom_fullname(has_custom_name ? shortname + name_len + 1 : "");
 
             auto min = dv.min;
             auto max = dv.max;
@@ -1157,32 +1205,26 @@ void EMSdevice::setCustomizationEntity(const std::string & entity_id) {
     }
 }
 
-// populate a string vector with entities that have masks set or have a custom name
-void EMSdevice::getCustomizationEntities(std::vector<std::string> & entity_ids) {
+// add the entities that have masks set or have a custom name, unless they are already in the list
+void EMSdevice::getCustomizationEntities(EntityCustomization & entityCustomization) {
     for (const auto & dv : devicevalues_) {
+        uint8_t mask = dv.state >> 4;
+        if (!mask && !dv.has_custom_fullname()) {
+            continue;
+        }
+
         char name[100];
-        name[0] = '\0';
         if (dv.tag >= DeviceValueTAG::TAG_HC1) {
-            // prefix tag
-            strcpy(name, tag_to_mqtt(dv.tag));
-            strcat(name, "/");
-        }
-        strcat(name, dv.short_name);
-        std::string entity_name = name;
-
-        uint8_t mask   = dv.state >> 4;
-        bool    is_set = false;
-        for (auto & eid : entity_ids) {
-            if (DeviceValue::get_name(eid) == entity_name) {
-                is_set = true;
-                break;
-            }
+            snprintf(name, sizeof(name), "%s/%s", tag_to_mqtt(dv.tag), dv.short_name); // prefix tag
+        } else {
+            strlcpy(name, dv.short_name, sizeof(name));
         }
-        if (!is_set && (mask || !dv.custom_fullname.empty())) {
-            if (dv.custom_fullname.empty()) {
-                entity_ids.push_back(Helpers::hextoa(mask, false) + entity_name);
+
+        if (entityCustomization.find_entity(name) == nullptr) {
+            if (!dv.has_custom_fullname()) {
+                entityCustomization.add_entity(Helpers::hextoa(mask, false) + name);
             } else {
-                entity_ids.push_back(Helpers::hextoa(mask, false) + entity_name + "|" + dv.custom_fullname);
+                entityCustomization.add_entity(Helpers::hextoa(mask, false) + name + "|" + dv.custom_fullname.get());
             }
         }
     }
@@ -1562,7 +1604,8 @@ void EMSdevice::publish_all_values() {
 // For each value in the device create the json object pair and add it to given json
 // return false if empty
 // this is used to create the MQTT payloads, Console messages and Web API call responses
-bool EMSdevice::generate_values(JsonObject output, const uint8_t tag_filter, const bool nested, const uint8_t output_target) {
+// with changed_only only the values flagged as changed since the last MQTT publish are added
+bool EMSdevice::generate_values(JsonObject output, const uint8_t tag_filter, const bool nested, const uint8_t output_target, const bool changed_only) {
     bool       has_values = false; // to see if we've added a value. it's faster than doing a json.size() at the end
     uint8_t    old_tag    = 255;   // NAN
     JsonObject json       = output;
@@ -1579,10 +1622,17 @@ bool EMSdevice::generate_values(JsonObject output, const uint8_t tag_filter, con
         //  2. it must have a visible flag
         //  3. it must match the given tag filter or have an empty tag
         //  4. it must not have the exclude flag set or outputs to console
+        //  5. it must have changed, if we only want the changes
         if (dv.has_state(DeviceValueState::DV_ACTIVE) && !fullname.empty() && (tag_filter == DeviceValueTAG::TAG_NONE || tag_filter == dv.tag)
-            && (output_target == OUTPUT_TARGET::CONSOLE || !dv.has_state(DeviceValueState::DV_API_MQTT_EXCLUDE))) {
+            && (output_target == OUTPUT_TARGET::CONSOLE || !dv.has_state(DeviceValueState::DV_API_MQTT_EXCLUDE))
+            && (!changed_only || dv.has_state(DeviceValueState::DV_CHANGED))) {
             has_values = true; // flagged if we actually have data
 
+            // it's going out to MQTT, so no longer a change
+            if (output_target == OUTPUT_TARGET::MQTT) {
+                dv.remove_state(DeviceValueState::DV_CHANGED);
+            }
+
             // we have a tag if it matches the filter given, and that the tag name is not empty/""
             bool have_tag = ((dv.tag != tag_filter) && dv.has_tag());
 
@@ -1726,45 +1776,84 @@ bool EMSdevice::generate_values(JsonObject output, const uint8_t tag_filter, con
 
 // create the Home Assistant configs for each device value / entity
 // this is called when an MQTT publish is done via an EMS Device in emsesp.cpp::publish_device_values()
-void EMSdevice::mqtt_ha_entity_config_create() {
+// create the HA discovery configs for the entities, publishing at most budget configs
+// continues where the last call stopped, so all entities get their turn
+// returns true when all entities have been checked, false if the budget ran out first
+bool EMSdevice::mqtt_ha_entity_config_create(uint8_t & budget) {
     bool create_device_config = !ha_config_done(); // do we need to create the main Discovery device config with this entity?
 
     // check the state of each of the device values
     // create climate if roomtemp is visible
     // create the discovery topic if if hasn't already been created, not a command (like reset) and is active and visible
-    for (auto & dv : devicevalues_) {
-        if (!strcmp(dv.short_name, FL_(haclimate)[0]) && !dv.has_state(DeviceValueState::DV_API_MQTT_EXCLUDE) && dv.has_state(DeviceValueState::DV_ACTIVE)) {
-            if (*(int8_t *)(dv.value_p) == 1 && (!dv.has_state(DeviceValueState::DV_HA_CONFIG_CREATED) || dv.has_state(DeviceValueState::DV_HA_CLIMATE_NO_RT))) {
-                if (Mqtt::publish_ha_climate_config(dv.tag, true, false, dv.min, dv.max)) { // roomTemp
-                    dv.remove_state(DeviceValueState::DV_HA_CLIMATE_NO_RT);
-                    dv.add_state(DeviceValueState::DV_HA_CONFIG_CREATED);
+    for (; ha_config_pass_ < 3; ha_config_pass_++) {
+        for (; ha_config_pos_ < devicevalues_.size(); ha_config_pos_++) {
+            auto &  dv   = devicevalues_[ha_config_pos_];
+            uint8_t pass = dv.has_state(DeviceValueState::DV_FAVORITE) ? 0 : dv.has_cmd ? 1 : 2;
+            if (pass != ha_config_pass_) {
+                continue;
+            }
+
+            if (!strcmp(dv.short_name, FL_(haclimate)[0]) && !dv.has_state(DeviceValueState::DV_API_MQTT_EXCLUDE) && dv.has_state(DeviceValueState::DV_ACTIVE)) {
+                if (*(int8_t *)(dv.value_p) == 1 && (!dv.has_state(DeviceValueState::DV_HA_CONFIG_CREATED) || dv.has_state(DeviceValueState::DV_HA_CLIMATE_NO_RT))) {
+                    if (!budget) {
+                        break;
+                    }
+                    budget--;
+                    if (Mqtt::publish_ha_climate_config(dv.tag, true, false, dv.min, dv.max)) { // roomTemp
+                        dv.remove_state(DeviceValueState::DV_HA_CLIMATE_NO_RT);
+                        dv.add_state(DeviceValueState::DV_HA_CONFIG_CREATED);
+                    }
+                } else if (*(int8_t *)(dv.value_p) == 0
+                           && (!dv.has_state(DeviceValueState::DV_HA_CONFIG_CREATED) || !dv.has_state(DeviceValueState::DV_HA_CLIMATE_NO_RT))) {
+                    if (!budget) {
+                        break;
+                    }
+                    budget--;
+                    if (Mqtt::publish_ha_climate_config(dv.tag, false, false, dv.min, dv.max)) { // no roomTemp
+                        dv.add_state(DeviceValueState::DV_HA_CLIMATE_NO_RT);
+                        dv.add_state(DeviceValueState::DV_HA_CONFIG_CREATED);
+                    }
+                }
+            }
+
+            if (!dv.has_state(DeviceValueState::DV_HA_CONFIG_CREATED) && dv.has_state(DeviceValueState::DV_ACTIVE)
+                && !dv.has_state(DeviceValueState::DV_API_MQTT_EXCLUDE)) {
+                if (!budget) {
+                    break;
                 }
-            } else if (*(int8_t *)(dv.value_p) == 0
-                       && (!dv.has_state(DeviceValueState::DV_HA_CONFIG_CREATED) || !dv.has_state(DeviceValueState::DV_HA_CLIMATE_NO_RT))) {
-                if (Mqtt::publish_ha_climate_config(dv.tag, false, false, dv.min, dv.max)) { // no roomTemp
-                    dv.add_state(DeviceValueState::DV_HA_CLIMATE_NO_RT);
+                budget--;
+                // create_device_config is only done once for the EMS device. It can added to any entity, so we take the first
+                if (Mqtt::publish_ha_sensor_config(dv, name(), brand_to_char(), false, create_device_config)) {
                     dv.add_state(DeviceValueState::DV_HA_CONFIG_CREATED);
+                    create_device_config = false; // only create the main config once
                 }
             }
         }
 
-        if (!dv.has_state(DeviceValueState::DV_HA_CONFIG_CREATED) && dv.has_state(DeviceValueState::DV_ACTIVE)
-            && !dv.has_state(DeviceValueState::DV_API_MQTT_EXCLUDE)) {
-            // create_device_config is only done once for the EMS device. It can added to any entity, so we take the first
-            if (Mqtt::publish_ha_sensor_config(dv, name(), brand_to_char(), false, create_device_config)) {
-                dv.add_state(DeviceValueState::DV_HA_CONFIG_CREATED);
-                create_device_config = false; // only create the main config once
-            }
-#ifndef EMSESP_STANDALONE
-            // always create minimum one config
-            if (ESP.getMaxAllocHeap() < (6 * 1024) || (!EMSESP::system_.PSram() && ESP.getFreeHeap() < (65 * 1024))) {
-                break;
-            }
-#endif
+        if (ha_config_pos_ < devicevalues_.size()) {
+            ha_config_done(!create_device_config);
+            return false; // out of budget, continue from here next time
         }
+        ha_config_pos_ = 0;
     }
 
+    // all checked, start again from the favorites next time
+    ha_config_pass_ = 0;
     ha_config_done(!create_device_config);
+    ha_config_pending(false);
+    return true;
+}
+
+// count the entities that need a HA config and how many of them have been published
+void EMSdevice::ha_config_count(uint16_t & created, uint16_t & total) const {
+    for (const auto & dv : devicevalues_) {
+        if (dv.has_state(DeviceValueState::DV_ACTIVE) && !dv.has_state(DeviceValueState::DV_API_MQTT_EXCLUDE)) {
+            total++;
+            if (dv.has_state(DeviceValueState::DV_HA_CONFIG_CREATED)) {
+                created++;
+            }
+        }
+    }
 }
 
 // remove all config topics in HA
@@ -1774,15 +1863,13 @@ void EMSdevice::ha_config_clear() {
     }
 
     ha_config_done(false); // this will force the recreation of the main HA device config
+    ha_config_pending(true);
+    ha_config_pass_ = 0;
+    ha_config_pos_  = 0;
 }
 
 bool EMSdevice::has_telegram_id(uint16_t id) const {
-    for (const auto & tf : telegram_functions_) {
-        if (tf.telegram_type_id_ == id) {
-            return true;
-        }
-    }
-    return false;
+    return find_telegram_function(id) >= 0;
 }
 
 // return the name of the telegram type
@@ -1806,35 +1893,60 @@ const char * EMSdevice::telegram_type_name(std::shared_ptr<const Telegram> teleg
 // take a telegram_type_id and call the matching handler
 // return true if match found
 bool EMSdevice::handle_telegram(std::shared_ptr<const Telegram> telegram) {
+    auto pos = find_telegram_function(telegram->type_id);
+    if (pos < 0) {
+        return false; // type not found
+    }
+    return process_telegram_function(telegram_functions_[pos], telegram);
+}
+
+#if defined(EMSESP_STANDALONE)
+// the original linear scan over all registered telegram types, to compare against in 'test dispatch'
+bool EMSdevice::handle_telegram_scan(std::shared_ptr<const Telegram> telegram) {
     for (auto & tf : telegram_functions_) {
         if (tf.telegram_type_id_ == telegram->type_id) {
-            // for telegram desitnation only read telegram
-            if (telegram->dest == device_id_ && telegram->message_length > 0) {
-                tf.process_function_(telegram);
-                return true;
-            }
-            // if the data block is empty and we have not received data before, assume that this telegram
-            // is not recognized by the bus master. So remove it from the automatic fetch list
-            if (telegram->message_length == 0 && telegram->offset == 0 && !tf.received_) {
-#if defined(EMSESP_DEBUG)
-                EMSESP::logger().debug("This telegram (%s) is not recognized by the EMS bus", tf.telegram_type_name_);
+            return process_telegram_function(tf, telegram);
+        }
+    }
+    return false; // type not found
+}
 #endif
-                // removing fetch after start causes issue: https://github.com/emsesp/EMS-ESP32/issues/1420
-                // continue retry the first 5 minutes, then disable (added 15.3.2024)
-                if (uuid::get_uptime_sec() > 600) {
-                    tf.fetch_ = false;
-                }
-                return false;
-            }
-            if (telegram->message_length > 0) {
-                tf.received_ = true;
-                tf.process_function_(telegram);
-            }
 
-            return true;
+// call the handler, return true if the telegram was handled
+bool EMSdevice::process_telegram_function(TelegramFunction & tf, std::shared_ptr<const Telegram> telegram) {
+    // for telegram desitnation only read telegram
+    if (telegram->dest == device_id_ && telegram->message_length > 0) {
+        call_telegram_function(tf, telegram);
+        return true;
+    }
+    // if the data block is empty and we have not received data before, assume that this telegram
+    // is not recognized by the bus master. So remove it from the automatic fetch list
+    if (telegram->message_length == 0 && telegram->offset == 0 && !tf.received_) {
+#if defined(EMSESP_DEBUG)
+        EMSESP::logger().debug("This telegram (%s) is not recognized by the EMS bus", tf.telegram_type_name_);
+#endif
+        // removing fetch after start causes issue: https://github.com/emsesp/EMS-ESP32/issues/1420
+        // continue retry the first 5 minutes, then disable (added 15.3.2024)
+        if (uuid::get_uptime_sec() > 600) {
+            tf.fetch_ = false;
         }
+        return false;
     }
-    return false; // type not found
+    if (telegram->message_length > 0) {
+        tf.received_ = true;
+        call_telegram_function(tf, telegram);
+    }
+
+    return true;
+}
+
+// run the handler and remember if it changed any value, for the scheduled fetch
+void EMSdevice::call_telegram_function(TelegramFunction & tf, std::shared_ptr<const Telegram> telegram) {
+    bool has_update = has_update_;
+    has_update_     = false;
+    tf.process_function_(telegram);
+    tf.changed_ |= has_update_;
+    has_update_ |= has_update;
 }
 
 // send Tx write with a data block
@@ -27,6 +27,8 @@
 
 namespace emsesp {
 
+class EntityCustomization;
+
 class EMSdevice {
   public:
     virtual ~EMSdevice() = default; // destructor of base class must always be virtual because it's a polymorphic class
@@ -53,6 +55,15 @@ class EMSdevice {
     static uint8_t      decode_brand(uint8_t value);
     static bool         export_values(uint8_t device_type, JsonObject output, const int8_t id, const uint8_t output_target);
 
+    // floor and ceiling of the scheduled fetch interval of a telegram, in fetch cycles
+    static void fetch_intervals(const uint8_t min, const uint8_t max) {
+        fetch_min_ = min ? min : 1;
+        fetch_max_ = max < fetch_min_ ? fetch_min_ : max;
+    }
+    static uint32_t fetch_skipped() {
+        return fetch_skipped_;
+    }
+
     // non static
 
     const char * device_type_name();                     // returns short non-translated device type name
@@ -137,14 +148,14 @@ class EMSdevice {
 
     inline void has_update(void * value) {
         has_update_ = true;
-        publish_value(value);
+        value_changed(value);
     }
 
     inline void has_update(char * value, const char * newvalue, size_t len) {
         if (strcmp(value, newvalue) != 0) {
             strlcpy(value, newvalue, len);
             has_update_ = true;
-            publish_value(value);
+            value_changed(value);
         }
     }
 
@@ -152,7 +163,7 @@ class EMSdevice {
         if (value != newvalue) {
             value       = newvalue;
             has_update_ = true;
-            publish_value((void *)&value);
+            value_changed((void *)&value);
         }
     }
 
@@ -160,7 +171,7 @@ class EMSdevice {
         if (value != newvalue) {
             value       = newvalue;
             has_update_ = true;
-            publish_value((void *)&value);
+            value_changed((void *)&value);
         }
     }
 
@@ -168,14 +179,14 @@ class EMSdevice {
         if (value != newvalue) {
             value       = newvalue;
             has_update_ = true;
-            publish_value((void *)&value);
+            value_changed((void *)&value);
         }
     }
 
     inline void has_enumupdate(std::shared_ptr<const Telegram> telegram, uint8_t & value, const uint8_t index, int8_t s = 0) {
         if (telegram->read_enumvalue(value, index, s)) {
             has_update_ = true;
-            publish_value((void *)&value);
+            value_changed((void *)&value);
         }
     }
 
@@ -183,7 +194,7 @@ class EMSdevice {
     inline void has_update(std::shared_ptr<const Telegram> telegram, Value & value, const uint8_t index, uint8_t s = 0) {
         if (telegram->read_value(value, index, s)) {
             has_update_ = true;
-            publish_value((void *)&value);
+            value_changed((void *)&value);
         }
     }
 
@@ -191,7 +202,7 @@ class EMSdevice {
     inline void has_bitupdate(std::shared_ptr<const Telegram> telegram, BitValue & value, const uint8_t index, uint8_t b) {
         if (telegram->read_bitvalue(value, index, b)) {
             has_update_ = true;
-            publish_value((void *)&value);
+            value_changed((void *)&value);
         }
     }
 
@@ -209,10 +220,13 @@ class EMSdevice {
 
     void set_climate_minmax(uint8_t tag, int16_t min, uint32_t max);
     void setCustomizationEntity(const std::string & entity_id);
-    void getCustomizationEntities(std::vector<std::string> & entity_ids);
+    void getCustomizationEntities(EntityCustomization & entityCustomization);
 
     void register_telegram_type(const uint16_t telegram_type_id, const char * telegram_type_name, bool fetch, const process_function_p cb);
     bool handle_telegram(std::shared_ptr<const Telegram> telegram);
+#if defined(EMSESP_STANDALONE)
+    bool handle_telegram_scan(std::shared_ptr<const Telegram> telegram); // old linear lookup, only used for benchmarking
+#endif
 
     std::string get_value_uom(const std::string & shortname) const;
 
@@ -220,7 +234,7 @@ class EMSdevice {
     void get_dv_info(JsonObject json);
 
     enum OUTPUT_TARGET : uint8_t { API_VERBOSE, API_SHORTNAMES, MQTT, CONSOLE };
-    bool generate_values(JsonObject output, const uint8_t tag_filter, const bool nested, const uint8_t output_target);
+    bool generate_values(JsonObject output, const uint8_t tag_filter, const bool nested, const uint8_t output_target, const bool changed_only = false);
     void generate_values_web(JsonObject output);
     void generate_values_web_customization(JsonArray output);
 
@@ -307,13 +321,15 @@ class EMSdevice {
     bool has_command(const void * value_p) const;
     void set_minmax(const void * value_p, int16_t min, uint32_t max);
     void publish_value(void * value_p) const;
+    void value_changed(void * value_p);
     void publish_all_values();
 
-    void mqtt_ha_entity_config_create();
+    bool mqtt_ha_entity_config_create(uint8_t & budget);
+    void ha_config_count(uint16_t & created, uint16_t & total) const;
 
     const char * telegram_type_name(std::shared_ptr<const Telegram> telegram);
 
-    void fetch_values();
+    void fetch_values(const bool scheduled = false);
     void toggle_fetch(uint16_t telegram_id, bool toggle);
     bool is_fetch(uint16_t telegram_id) const;
     bool is_received(uint16_t telegram_id) const;
@@ -327,6 +343,13 @@ class EMSdevice {
         ha_config_done_ = v;
     }
 
+    bool ha_config_pending() const {
+        return ha_config_pending_;
+    }
+    void ha_config_pending(const bool v) {
+        ha_config_pending_ = v;
+    }
+
     enum Brand : uint8_t {
         NO_BRAND = 0, // 0
         BOSCH,        // 1
@@ -461,11 +484,23 @@ class EMSdevice {
     bool ha_config_done_ = false;
     bool has_update_     = false;
 
+    static uint8_t  fetch_min_;
+    static uint8_t  fetch_max_;
+    static uint32_t fetch_skipped_; // # scheduled reads left out because the telegram did not change
+
+    // HA discovery cursor, walking the favorites first, then the entities with a command and then the rest
+    bool     ha_config_pending_ = false; // entities need to be checked for new HA configs
+    uint8_t  ha_config_pass_    = 0;
+    uint16_t ha_config_pos_     = 0;
+
     struct TelegramFunction {
         const uint16_t           telegram_type_id_;   // it's type_id
         const char *             telegram_type_name_; // e.g. RC20Message
         bool                     fetch_;              // if this type_id be queried automatically
         bool                     received_;
+        bool                     changed_        = false; // a value changed since the last scheduled fetch
+        uint8_t                  fetch_interval_ = 1;     // fetch cycles between scheduled fetches
+        uint8_t                  fetch_wait_     = 0;     // fetch cycles left until the next scheduled fetch
         const process_function_p process_function_;
 
         TelegramFunction(uint16_t telegram_type_id, const char * telegram_type_name, bool fetch, bool received, const process_function_p process_function)
@@ -479,8 +514,29 @@ class EMSdevice {
 
     std::vector<TelegramFunction> telegram_functions_; // each EMS device has its own set of registered telegram types
 
+    // positions in telegram_functions_, sorted by type_id for a binary search
+    // duplicate type_ids keep their registration order so the first registered handler wins, like a linear scan
+    struct TelegramIndex {
+        uint16_t type_id;
+        uint16_t pos;
+    };
+    std::vector<TelegramIndex> telegram_index_;
+
+    int16_t find_telegram_function(const uint16_t telegram_type_id) const;
+    bool    process_telegram_function(TelegramFunction & tf, std::shared_ptr<const Telegram> telegram);
+    void    call_telegram_function(TelegramFunction & tf, std::shared_ptr<const Telegram> telegram);
+
     std::vector<DeviceValue> devicevalues_; // all the device values
 
+    // positions in devicevalues_, sorted by value_p so value_changed() doesn't scan all entities
+    struct ValueIndex {
+        const void * value_p;
+        uint16_t     pos;
+    };
+    std::vector<ValueIndex> value_index_;
+
+    int16_t find_device_value(const void * value_p) const;
+
     std::vector<uint16_t> handlers_ignored_;
 };
 
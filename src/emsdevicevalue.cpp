@@ -32,27 +32,28 @@ DeviceValue::DeviceValue(uint8_t               device_type,
                          int8_t                numeric_operator,
                          const char * const    short_name,
                          const char * const *  fullname,
-                         std::string &         custom_fullname,
+                         const std::string &   custom_fullname,
                          uint8_t               uom,
                          bool                  has_cmd,
                          int16_t               min,
                          uint32_t              max,
                          uint8_t               state)
-    : device_type(device_type)
-    , tag(tag)
-    , value_p(value_p)
-    , type(type)
+    : value_p(value_p)
     , options(options)
     , options_single(options_single)
-    , numeric_operator(numeric_operator)
     , short_name(short_name)
     , fullname(fullname)
-    , custom_fullname(custom_fullname)
+    , max(max)
+    , min(min)
+    , device_type(device_type)
+    , tag(tag)
+    , type(type)
+    , numeric_operator(numeric_operator)
     , uom(uom)
     , has_cmd(has_cmd)
-    , min(min)
-    , max(max)
     , state(state) {
+    set_custom_fullname(custom_fullname);
+
     // calculate #options in options list
     if (options_single) {
         options_size = 1;
@@ -70,9 +71,9 @@ DeviceValue::DeviceValue(uint8_t               device_type,
     Serial.print(" registering entity: ");
     Serial.print((short_name));
     Serial.print("/");
-    if (!custom_fullname.empty()) {
+    if (has_custom_fullname()) {
         Serial.print(COLOR_BRIGHT_CYAN);
-        Serial.print(custom_fullname.c_str());
+        Serial.print(custom_fullname.get());
         Serial.print(COLOR_RESET);
     } else {
         Serial.print(Helpers::translated_word(fullname));
@@ -323,11 +324,11 @@ bool DeviceValue::get_min_max(int16_t & dv_set_min, uint32_t & dv_set_max) {
 
 // extract custom min from custom_fullname
 bool DeviceValue::get_custom_min(int16_t & val) {
-    auto    min_pos    = custom_fullname.find('>');
-    bool    has_min    = (min_pos != std::string::npos);
+    auto    min_pos    = has_custom_fullname() ? strchr(custom_fullname.get(), '>') : nullptr;
+    bool    has_min    = (min_pos != nullptr);
     uint8_t fahrenheit = !EMSESP::system_.fahrenheit() ? 0 : (uom == DeviceValueUOM::DEGREES) ? 2 : (uom == DeviceValueUOM::DEGREES_R) ? 1 : 0;
     if (has_min) {
-        int16_t v = Helpers::atoint(custom_fullname.substr(min_pos + 1).c_str());
+        int16_t v = Helpers::atoint(min_pos + 1);
         if (fahrenheit) {
             v = (v - (32 * (fahrenheit - 1))) / 1.8; // reset to °C
         }
@@ -341,11 +342,11 @@ bool DeviceValue::get_custom_min(int16_t & val) {
 
 // extract custom max from custom_fullname
 bool DeviceValue::get_custom_max(uint32_t & val) {
-    auto    max_pos    = custom_fullname.find('<');
-    bool    has_max    = (max_pos != std::string::npos);
+    auto    max_pos    = has_custom_fullname() ? strchr(custom_fullname.get(), '<') : nullptr;
+    bool    has_max    = (max_pos != nullptr);
     uint8_t fahrenheit = !EMSESP::system_.fahrenheit() ? 0 : (uom == DeviceValueUOM::DEGREES) ? 2 : (uom == DeviceValueUOM::DEGREES_R) ? 1 : 0;
     if (has_max) {
-        int32_t v = Helpers::atoint(custom_fullname.substr(max_pos + 1).c_str());
+        int32_t v = Helpers::atoint(max_pos + 1);
         if (fahrenheit) {
             v = (v - (32 * (fahrenheit - 1))) / 1.8; // reset to °C
         }
@@ -363,14 +364,27 @@ void DeviceValue::set_custom_minmax() {
     get_custom_max(max);
 }
 
+// sets or clears the custom fullname, only allocating memory when there is one
+void DeviceValue::set_custom_fullname(const std::string & custom_name) {
+    if (custom_name.empty()) {
+        custom_fullname.reset();
+        return;
+    }
+    custom_fullname.reset(new char[custom_name.length() + 1]);
+    strcpy(custom_fullname.get(), custom_name.c_str());
+}
+
+// returns the custom fullname without the min/max
 std::string DeviceValue::get_custom_fullname() const {
-    auto min_pos    = custom_fullname.find('>');
-    auto max_pos    = custom_fullname.find('<');
-    auto minmax_pos = min_pos < max_pos ? min_pos : max_pos;
+    if (!has_custom_fullname()) {
+        return std::string("");
+    }
+    std::string customname = custom_fullname.get();
+    auto        minmax_pos = customname.find_first_of("><");
     if (minmax_pos != std::string::npos) {
-        return custom_fullname.substr(0, minmax_pos);
+        return customname.substr(0, minmax_pos);
     }
-    return custom_fullname;
+    return customname;
 }
 
 // returns the translated fullname or the custom fullname (if provided)
@@ -23,6 +23,8 @@
 #include <Arduino.h>
 #include <ArduinoJson.h>
 
+#include <memory>
+
 #include "helpers.h"          // for conversions
 #include "default_settings.h" // for enum types
 
@@ -126,6 +128,7 @@ class DeviceValue {
         DV_ACTIVE            = (1 << 0), // 1 - has a validated real value
         DV_HA_CONFIG_CREATED = (1 << 1), // 2 - set if the HA config topic has been created
         DV_HA_CLIMATE_NO_RT  = (1 << 2), // 4 - climate created without roomTemp
+        DV_CHANGED           = (1 << 3), // 8 - value changed since it was last published to MQTT
 
         // high nibble as mask for exclusions & special functions
         DV_WEB_EXCLUDE      = (1 << 4), // 16 - not shown on web
@@ -148,22 +151,25 @@ class DeviceValue {
         DV_NUMOP_MUL50  = -50
     };
 
-    uint8_t               device_type;    // EMSdevice::DeviceType
-    uint8_t               tag;            // DeviceValueTAG::*
-    void *                value_p;        // pointer to variable of any type
-    uint8_t               type;           // DeviceValueType::*
-    const char * const ** options;        // options as a flash char array
-    const char * const *  options_single; // options are not translated
-    int8_t                numeric_operator;
-    uint8_t               options_size;    // number of options in the char array, calculated
-    const char * const    short_name;      // used in MQTT and API
-    const char * const *  fullname;        // used in Web and Console, is translated
-    std::string           custom_fullname; // optional, from customization
-    uint8_t               uom;             // DeviceValueUOM::*
-    bool                  has_cmd;         // true if there is a Console/MQTT command which matches the short_name
-    int16_t               min;             // min range
-    uint32_t              max;             // max range
-    uint8_t               state;           // DeviceValueState::*
+    // members are ordered by size to avoid padding, as there is one DeviceValue for every entity of every device
+    // TODO the immutable metadata (names, options, type, uom, numeric operator, min/max) is still copied into every entity,
+    // move it into const tables per device class so only value_p, state and a table index are left here
+    void *                  value_p;          // pointer to variable of any type
+    const char * const **   options;          // options as a flash char array
+    const char * const *    options_single;   // options are not translated
+    const char * const      short_name;       // used in MQTT and API
+    const char * const *    fullname;         // used in Web and Console, is translated
+    std::unique_ptr<char[]> custom_fullname;  // optional, from customization. nullptr if not set
+    uint32_t                max;              // max range
+    int16_t                 min;              // min range
+    uint8_t                 device_type;      // EMSdevice::DeviceType
+    uint8_t                 tag;              // DeviceValueTAG::*
+    uint8_t                 type;             // DeviceValueType::*
+    int8_t                  numeric_operator; // DeviceValueNumOp::*
+    uint8_t                 options_size;     // number of options in the char array, calculated
+    uint8_t                 uom;              // DeviceValueUOM::*
+    bool                    has_cmd;          // true if there is a Console/MQTT command which matches the short_name
+    uint8_t                 state;            // DeviceValueState::*
 
     DeviceValue(uint8_t               device_type,
                 uint8_t               tag,
@@ -174,7 +180,7 @@ class DeviceValue {
                 int8_t                numeric_operator,
                 const char * const    short_name,
                 const char * const *  fullname,
-                std::string &         custom_fullname,
+                const std::string &   custom_fullname,
                 uint8_t               uom,
                 bool                  has_cmd,
                 int16_t               min,
@@ -188,6 +194,10 @@ class DeviceValue {
     void               set_custom_minmax();
     bool               get_custom_min(int16_t & val);
     bool               get_custom_max(uint32_t & val);
+    void               set_custom_fullname(const std::string & custom_name);
+    bool               has_custom_fullname() const {
+        return custom_fullname != nullptr;
+    }
     std::string        get_custom_fullname() const;
     std::string        get_fullname() const;
     static std::string get_name(std::string & entity);
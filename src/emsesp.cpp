@@ -85,7 +85,9 @@ uint16_t EMSESP::response_id_      = 0;
 bool     EMSESP::tap_water_active_ = false; // for when Boiler states we having running warm water. used in Shower()
 uint32_t EMSESP::last_fetch_       = 0;
 uint8_t  EMSESP::publish_all_idx_  = 0;
+uint8_t  EMSESP::ha_discovery_idx_ = 0;
 uint8_t  EMSESP::unique_id_count_  = 0;
+uint8_t  EMSESP::device_lookup_[0x80] = {0};
 bool     EMSESP::trace_raw_        = false;
 uint16_t EMSESP::wait_validate_    = 0;
 bool     EMSESP::wait_km_          = true;
@@ -286,19 +288,22 @@ void EMSESP::show_ems(uuid::console::Shell & shell) {
         shell.printfln("  #write fails (after %d retries): %d", TxService::MAXIMUM_TX_RETRIES, txservice_.telegram_write_fail_count());
         shell.printfln("  Rx line quality: %d%%", rxservice_.quality());
         shell.printfln("  Tx line quality: %d%%", (txservice_.read_quality() + txservice_.read_quality()) / 2);
+        shell.printfln("  Bus load: %d%% (own %d%%, max %d%%), Tx deferred: %d",
+                       rxservice_.bus_load().utilization(::millis()),
+                       rxservice_.bus_load().own_utilization(::millis()),
+                       txservice_.pacer().share(),
+                       txservice_.pacer().deferred());
         shell.println();
     }
 
     // Rx queue
-    auto rx_telegrams = rxservice_.queue();
-    if (rx_telegrams.empty()) {
+    auto rx_size = rxservice_.queue_size();
+    if (rx_size == 0) {
         shell.printfln("Rx Queue is empty");
     } else {
-        shell.printfln("Rx Queue (%ld telegram%s):", rx_telegrams.size(), rx_telegrams.size() == 1 ? "" : "s");
-        for (const auto & it : rx_telegrams) {
-            shell.printfln(" [%02d] %s", it.id_, pretty_telegram(it.telegram_).c_str());
-        }
+        shell.printfln("Rx Queue (%d telegram%s)", rx_size, rx_size == 1 ? "" : "s");
     }
+    shell.printfln(" max queued: %d/%d, overruns: %d", rxservice_.queue_high_water(), RxFrameQueue::QUEUE_SIZE, rxservice_.queue_overruns());
 
     shell.println();
 
@@ -307,7 +312,12 @@ void EMSESP::show_ems(uuid::console::Shell & shell) {
     if (tx_telegrams.empty()) {
         shell.printfln("Tx Queue is empty");
     } else {
-        shell.printfln("Tx Queue (%ld telegram%s):", tx_telegrams.size(), tx_telegrams.size() == 1 ? "" : "s");
+        shell.printfln("Tx Queue (%ld telegram%s, high/user/fetch: %d/%d/%d):",
+                       tx_telegrams.size(),
+                       tx_telegrams.size() == 1 ? "" : "s",
+                       txservice_.queue_size(TxService::PRIORITY_HIGH),
+                       txservice_.queue_size(TxService::PRIORITY_USER),
+                       txservice_.queue_size(TxService::PRIORITY_FETCH));
 
         std::string op;
         for (const auto & it : tx_telegrams) {
@@ -321,6 +331,7 @@ void EMSESP::show_ems(uuid::console::Shell & shell) {
             shell.printfln(" [%02d%c] %s %s", it.id_, ((it.retry_) ? '*' : ' '), op.c_str(), pretty_telegram(it.telegram_).c_str());
         }
     }
+    shell.printfln(" reads coalesced: %d, writes superseded: %d", txservice_.reads_coalesced(), txservice_.writes_superseded());
 
     shell.println();
 }
@@ -335,6 +346,18 @@ void EMSESP::dump_all_values(uuid::console::Shell & shell) {
         "device name,device type,product id,shortname,fullname,type [options...] \\| (min/max),uom,writeable,discovery entityid v3.4, discovery entityid");
     Serial.println();
 
+    // add the devices and print out all the entities
+    size_t first = emsdevices.size();
+    add_all_devices();
+    for (size_t i = first; i < emsdevices.size(); i++) {
+        emsdevices[i]->dump_value_info();
+    }
+
+    Serial.println("---- CSV END ----"); // marker use by py script
+}
+
+// add one of each device in the library, sorted by device type
+void EMSESP::add_all_devices() {
     for (const auto & device_class : EMSFactory::device_handlers()) {
         // go through each device type so they are sorted
         for (const auto & device : device_library_) {
@@ -354,18 +377,14 @@ void EMSESP::dump_all_values(uuid::console::Shell & shell) {
                     }
                 }
 
-                // add the device and print out all the entities
-
                 // if (device.product_id == 69) { // only for testing mixer
                 emsdevices.push_back(
                     EMSFactory::add(device.device_type, device_id, device.product_id, "1.0", device.name, device.flags, EMSdevice::Brand::NO_BRAND));
-                emsdevices.back()->dump_value_info();
                 // } // only for testing mixer
             }
         }
     }
-
-    Serial.println("---- CSV END ----"); // marker use by py script
+    index_devices();
 }
 #endif
 
@@ -536,6 +555,52 @@ void EMSESP::publish_all_loop() {
     }
 }
 
+// create the HA configs of the devices that have published their values, a few per loop
+// the number depends on how full the MQTT queue is and on the free memory
+void EMSESP::ha_discovery_loop() {
+    if (!Mqtt::connected() || !Mqtt::ha_enabled() || publish_all_idx_ || emsdevices.empty()) {
+        return;
+    }
+
+    uint16_t queued = Mqtt::publish_queued();
+    if (queued >= HA_DISCOVERY_QUEUE_MAX) {
+        return;
+    }
+    uint8_t budget = std::min<uint16_t>(HA_DISCOVERY_QUEUE_MAX - queued, HA_DISCOVERY_MAX_PER_LOOP);
+#ifndef EMSESP_STANDALONE
+    // low on memory, only add one when the queue is empty so we still make progress
+    if (ESP.getMaxAllocHeap() < (6 * 1024) || (!system_.PSram() && ESP.getFreeHeap() < (65 * 1024))) {
+        if (queued) {
+            return;
+        }
+        budget = 1;
+    }
+#endif
+
+    // take the devices in turn, staying with a device until all its entities are checked
+    for (uint8_t i = 0; i < emsdevices.size() && budget; i++) {
+        if (ha_discovery_idx_ >= emsdevices.size()) {
+            ha_discovery_idx_ = 0;
+        }
+        const auto & emsdevice = emsdevices[ha_discovery_idx_];
+        if (emsdevice && emsdevice->ha_config_pending() && !emsdevice->mqtt_ha_entity_config_create(budget)) {
+            return; // out of budget
+        }
+        ha_discovery_idx_++;
+    }
+}
+
+// the number of HA configs published of all the ones needed by the EMS devices
+void EMSESP::ha_discovery_progress(uint16_t & created, uint16_t & total) {
+    created = 0;
+    total   = 0;
+    for (const auto & emsdevice : emsdevices) {
+        if (emsdevice) {
+            emsdevice->ha_config_count(created, total);
+        }
+    }
+}
+
 // force HA to re-create all the devices next time they are detected
 // also removes the old HA topics
 void EMSESP::reset_mqtt_ha() {
@@ -555,7 +620,20 @@ void EMSESP::reset_mqtt_ha() {
 // create json doc for the devices values and add to MQTT publish queue
 // this will also create the HA /config topic for each device value
 // generate_values_json is called to build the device value (dv) object array
-void EMSESP::publish_device_values(uint8_t device_type) {
+// a changed-only payload is never retained, so the retained message on the topic stays the last full state
+void EMSESP::publish_device_topic(const std::string & topic, const JsonObjectConst payload, const bool changed_only) {
+    if (changed_only) {
+        Mqtt::queue_publish_retain(topic, payload, false);
+    } else {
+        Mqtt::queue_publish(topic, payload);
+    }
+}
+
+// with changed_only only the values that changed since the last publish are sent, and topics without changes are skipped
+void EMSESP::publish_device_values(uint8_t device_type, const bool changed_only) {
+    uint32_t start_us = Perf::now_us();
+    Perf::published(device_type);
+
     JsonDocument doc;
     JsonObject   json         = doc.to<JsonObject>();
     bool         need_publish = false;
@@ -571,11 +649,14 @@ void EMSESP::publish_device_values(uint8_t device_type) {
                     json_tag     = doc[EMSdevice::tag_to_mqtt(tag)].to<JsonObject>();
                     nest_created = true;
                 }
-                need_publish |= emsdevice->generate_values(json_tag, tag, false, EMSdevice::OUTPUT_TARGET::MQTT);
+                need_publish |= emsdevice->generate_values(json_tag, tag, false, EMSdevice::OUTPUT_TARGET::MQTT, changed_only);
             }
         }
+        if (changed_only && nest_created && json_tag.size() == 0) {
+            doc.remove(EMSdevice::tag_to_mqtt(tag)); // no changes for this tag
+        }
         if (need_publish && ((!nested && tag >= DeviceValueTAG::TAG_DEVICE_DATA_WW) || (tag == DeviceValueTAG::TAG_BOILER_DATA_WW))) {
-            Mqtt::queue_publish(Mqtt::tag_to_topic(device_type, tag), json);
+            publish_device_topic(Mqtt::tag_to_topic(device_type, tag), json, changed_only);
             json         = doc.to<JsonObject>();
             need_publish = false;
         }
@@ -585,17 +666,20 @@ void EMSESP::publish_device_values(uint8_t device_type) {
         if (doc.overflowed()) {
             LOG_WARNING("MQTT buffer overflow, please use individual topics");
         }
-        Mqtt::queue_publish(Mqtt::tag_to_topic(device_type, DeviceValueTAG::TAG_NONE), json);
+        publish_device_topic(Mqtt::tag_to_topic(device_type, DeviceValueTAG::TAG_NONE), json, changed_only);
     }
 
     // we want to create the /config topic after the data payload to prevent HA from throwing up a warning
+    // so flag the devices here and let ha_discovery_loop() create them
     if (Mqtt::ha_enabled()) {
         for (const auto & emsdevice : emsdevices) {
             if (emsdevice && (emsdevice->device_type() == device_type)) {
-                emsdevice->mqtt_ha_entity_config_create();
+                emsdevice->ha_config_pending(true);
             }
         }
     }
+
+    Perf::add(Perf::PUBLISH_BUILD, start_us);
 }
 
 // call the devices that don't need special attention
@@ -938,72 +1022,127 @@ bool EMSESP::process_telegram(std::shared_ptr<const Telegram> telegram) {
 
     // match device_id and type_id
     // calls the associated process function for that EMS device
-    // returns false if the device_id doesn't recognize it
     // after the telegram has been processed, see if there have been values changed and we need to do a MQTT publish
-    bool    telegram_found = false;
-    uint8_t device_found   = 0;
+    EMSdevice * emsdevice      = nullptr;
+    bool        telegram_found = dispatch_telegram(telegram, emsdevice);
+    if (emsdevice) {
+        if (!telegram_found && telegram->message_length > 0) {
+            emsdevice->add_handlers_ignored(telegram->type_id);
+        }
+        if (wait_validate_ == telegram->type_id) {
+            wait_validate_ = 0;
+        }
+        if (telegram_found && emsdevice->has_update()) {
+            Perf::value_changed(emsdevice->device_type());
+        }
+        if (Mqtt::connected() && telegram_found
+            && ((mqtt_.get_publish_onchange(emsdevice->device_type()) && emsdevice->has_update())
+                || (telegram->type_id == publish_id_ && telegram->dest == EMSbus::ems_bus_id()))) {
+            if (telegram->type_id == publish_id_) {
+                publish_id_ = 0;
+            }
+            emsdevice->has_update(false); // reset flag
+            if (!Mqtt::publish_single()) {
+                publish_device_values(emsdevice->device_type(), Mqtt::publish_changed()); // publish to MQTT if we explicitly have too
+            }
+        }
+    }
+    // handle unknown broadcasted telegrams (or send to us)
+    if (!telegram_found && (telegram->dest == 0 || telegram->dest == EMSbus::ems_bus_id())) {
+        LOG_DEBUG("No telegram type handler found for ID 0x%02X (src 0x%02X)", telegram->type_id, telegram->src);
+        if (watch() == WATCH_UNKNOWN) {
+            LOG_NOTICE("%s", pretty_telegram(telegram).c_str());
+        }
+        if (!wait_km_ && !emsdevice && (telegram->src != EMSbus::ems_bus_id()) && (telegram->message_length > 0)) {
+            send_read_request(EMSdevice::EMS_TYPE_VERSION, telegram->src);
+        }
+    }
+
+    return telegram_found;
+}
+
+// find the device that handles the telegram and call its handler
+// returns false if the device doesn't recognize the type_id, emsdevice is set to the device that was tried
+// the order is: broadcast or sent to us, a command to the device, a send to the master thermostat
+bool EMSESP::dispatch_telegram(std::shared_ptr<const Telegram> telegram, EMSdevice *& emsdevice) {
     // broadcast or send to us
+    if (telegram->dest == 0 || telegram->dest == EMSbus::ems_bus_id()) {
+        emsdevice = find_device(telegram->src);
+        if (emsdevice && emsdevice->handle_telegram(telegram)) {
+            return true;
+        }
+    }
+    // check for command to the device
+    if (telegram->src != EMSbus::ems_bus_id()) {
+        auto dest_device = find_device(telegram->dest);
+        if (dest_device) {
+            emsdevice = dest_device;
+            if (emsdevice->handle_telegram(telegram)) {
+                return true;
+            }
+        }
+    }
+    // check for sends to master thermostat
+    if (telegram->dest == 0x10) {
+        auto src_device = find_device(telegram->src);
+        if (src_device) {
+            emsdevice = src_device;
+            return emsdevice->handle_telegram(telegram);
+        }
+    }
+    return false;
+}
+
+#ifdef EMSESP_STANDALONE
+// the original lookup, scanning all devices for each of the three cases, to compare against in 'test dispatch'
+bool EMSESP::dispatch_telegram_scan(std::shared_ptr<const Telegram> telegram, EMSdevice *& device) {
+    bool telegram_found = false;
     for (const auto & emsdevice : emsdevices) {
         if (emsdevice->is_device_id(telegram->src) && (telegram->dest == 0 || telegram->dest == EMSbus::ems_bus_id())) {
-            telegram_found = emsdevice->handle_telegram(telegram);
-            device_found   = emsdevice->unique_id();
+            telegram_found = emsdevice->handle_telegram_scan(telegram);
+            device         = emsdevice.get();
             break;
         }
     }
     if (!telegram_found) {
-        // check for command to the device
         for (const auto & emsdevice : emsdevices) {
             if (emsdevice->is_device_id(telegram->dest) && telegram->src != EMSbus::ems_bus_id()) {
-                telegram_found = emsdevice->handle_telegram(telegram);
-                device_found   = emsdevice->unique_id();
+                telegram_found = emsdevice->handle_telegram_scan(telegram);
+                device         = emsdevice.get();
                 break;
             }
         }
     }
     if (!telegram_found) {
-        // check for sends to master thermostat
         for (const auto & emsdevice : emsdevices) {
             if (emsdevice->is_device_id(telegram->src) && telegram->dest == 0x10) {
-                telegram_found = emsdevice->handle_telegram(telegram);
-                device_found   = emsdevice->unique_id();
+                telegram_found = emsdevice->handle_telegram_scan(telegram);
+                device         = emsdevice.get();
                 break;
             }
         }
     }
+    return telegram_found;
+}
+#endif
+
+// rebuild the device_id lookup, must be called each time emsdevices changes
+void EMSESP::index_devices() {
+    memset(device_lookup_, 0, sizeof(device_lookup_));
+    uint8_t pos = 0;
     for (const auto & emsdevice : emsdevices) {
-        if (emsdevice->unique_id() == device_found) {
-            if (!telegram_found && telegram->message_length > 0) {
-                emsdevice->add_handlers_ignored(telegram->type_id);
-            }
-            if (wait_validate_ == telegram->type_id) {
-                wait_validate_ = 0;
-            }
-            if (Mqtt::connected() && telegram_found
-                && ((mqtt_.get_publish_onchange(emsdevice->device_type()) && emsdevice->has_update())
-                    || (telegram->type_id == publish_id_ && telegram->dest == EMSbus::ems_bus_id()))) {
-                if (telegram->type_id == publish_id_) {
-                    publish_id_ = 0;
-                }
-                emsdevice->has_update(false); // reset flag
-                if (!Mqtt::publish_single()) {
-                    publish_device_values(emsdevice->device_type()); // publish to MQTT if we explicitly have too
-                }
-            }
-            break;
-        }
-    }
-    // handle unknown broadcasted telegrams (or send to us)
-    if (!telegram_found && (telegram->dest == 0 || telegram->dest == EMSbus::ems_bus_id())) {
-        LOG_DEBUG("No telegram type handler found for ID 0x%02X (src 0x%02X)", telegram->type_id, telegram->src);
-        if (watch() == WATCH_UNKNOWN) {
-            LOG_NOTICE("%s", pretty_telegram(telegram).c_str());
-        }
-        if (!wait_km_ && !device_found && (telegram->src != EMSbus::ems_bus_id()) && (telegram->message_length > 0)) {
-            send_read_request(EMSdevice::EMS_TYPE_VERSION, telegram->src);
+        pos++;
+        auto & entry = device_lookup_[emsdevice->device_id() & 0x7F];
+        if (entry == 0) {
+            entry = pos; // first device wins, same as looping through emsdevices
         }
     }
+}
 
-    return telegram_found;
+// return the first device with this device_id, or nullptr
+EMSdevice * EMSESP::find_device(const uint8_t device_id) {
+    auto pos = device_lookup_[device_id & 0x7F];
+    return pos ? emsdevices[pos - 1].get() : nullptr;
 }
 
 // return true if we have this device already registered
@@ -1120,6 +1259,7 @@ bool EMSESP::add_device(const uint8_t device_id, const uint8_t product_id, const
         LOG_NOTICE("Unrecognized EMS device (deviceID 0x%02X, productID %d). Please report on GitHub.", device_id, product_id);
         emsdevices.push_back(
             EMSFactory::add(DeviceType::GENERIC, device_id, product_id, version, "unknown", DeviceFlags::EMS_DEVICE_FLAG_NONE, EMSdevice::Brand::NO_BRAND));
+        index_devices();
         return false; // not found
     }
 
@@ -1201,6 +1341,7 @@ bool EMSESP::add_device(const uint8_t device_id, const uint8_t product_id, const
     std::sort(emsdevices.begin(), emsdevices.end(), [](const std::unique_ptr<EMSdevice> & a, const std::unique_ptr<EMSdevice> & b) {
         return a->device_type() < b->device_type();
     });
+    index_devices();
 
     fetch_device_values(device_id); // go and fetch its data
 
@@ -1302,6 +1443,8 @@ void EMSESP::incoming_telegram(uint8_t * data, const uint8_t length) {
 #ifdef EMSESP_UART_DEBUG
     static uint32_t rx_time_ = 0;
 #endif
+    rxservice_.add_bus_load(data, length);
+
     // check first for echo
     uint8_t first_value = data[0];
     if (((first_value & 0x7F) == EMSbus::ems_bus_id()) && (length > 1)) {
@@ -1317,7 +1460,8 @@ void EMSESP::incoming_telegram(uint8_t * data, const uint8_t length) {
     }
 
     // are we waiting for a response from a recent Tx Read or Write?
-    uint8_t tx_state = EMSbus::tx_state();
+    uint8_t tx_state   = EMSbus::tx_state();
+    bool    more_parts = false; // the next part of a long telegram is read, the RxService collects them
     if (tx_state != Telegram::Operation::NONE) {
         bool tx_successful = false;
         EMSbus::tx_state(Telegram::Operation::NONE); // reset Tx wait state
@@ -1350,7 +1494,10 @@ void EMSESP::incoming_telegram(uint8_t * data, const uint8_t length) {
 
                 // if telegram is longer read next part with offset +25 for ems+ or +27 for ems1.0
                 // not for response to raw send commands without read_id set
-                if ((response_id_ == 0 || read_id_ > 0) && (length >= 31) && (txservice_.read_next_tx(data[3], length) == read_id_)) {
+                bool     long_read = (response_id_ == 0 || read_id_ > 0) && (length >= 31);
+                uint16_t next_id   = long_read ? txservice_.read_next_tx(data[3], length) : 0;
+                more_parts         = (next_id != 0);
+                if (long_read && (next_id == read_id_)) {
                     read_next_ = true;
                     txservice_.send();
                 } else {
@@ -1408,7 +1555,7 @@ void EMSESP::incoming_telegram(uint8_t * data, const uint8_t length) {
 #endif
         Roomctrl::check((data[1] ^ 0x80 ^ rxservice_.ems_mask()), data, length); // check if there is a message for the roomcontroller
 
-        rxservice_.add(data, length); // add to RxQueue
+        rxservice_.add(data, length, more_parts); // add to RxQueue
     }
 }
 
@@ -1421,16 +1568,20 @@ void EMSESP::scheduled_fetch_values() {
             no          = 1;
         }
 
-        if (txservice_.tx_queue_empty()) {
+        // the reads of the fetch queue up behind everything else, one device at a time
+        if (txservice_.queue_size(TxService::PRIORITY_FETCH) == 0) {
+            txservice_.read_priority(TxService::PRIORITY_FETCH);
             uint8_t i = 0;
             for (const auto & emsdevice : emsdevices) {
                 if (++i >= no) {
-                    emsdevice->fetch_values();
+                    emsdevice->fetch_values(true);
+                    txservice_.read_priority(TxService::PRIORITY_USER);
                     no++;
                     return;
                 }
             }
             webCustomEntityService.fetch();
+            txservice_.read_priority(TxService::PRIORITY_USER);
             no = 0;
         }
     }
@@ -1564,10 +1715,12 @@ void EMSESP::loop() {
         // service loops
         webLogService.loop();       // log in Web UI
         rxservice_.loop();          // process any incoming Rx telegrams
+        webDataService.loop();      // send dashboard data held back until a write is validated
         shower_.loop();             // check for shower on/off
         temperaturesensor_.loop();  // read sensor temperatures
         analogsensor_.loop();       // read analog sensor values
         publish_all_loop();         // with HA messages in parts to avoid flooding the mqtt queue
+        ha_discovery_loop();        // create the HA configs, a few at a time
         mqtt_.loop();               // sends out anything in the MQTT queue
         webSchedulerService.loop(); // handle any scheduled jobs
 
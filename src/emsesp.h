@@ -90,11 +90,12 @@ class EMSESP {
 
     static uuid::log::Logger logger();
 
-    static void publish_device_values(uint8_t device_type);
+    static void publish_device_values(uint8_t device_type, const bool changed_only = false);
     static void publish_other_values();
     static void publish_sensor_values(const bool time, const bool force = false);
     static void publish_all(bool force = false);
     static void reset_mqtt_ha();
+    static void ha_discovery_progress(uint16_t & created, uint16_t & total);
 
 #ifdef EMSESP_STANDALONE
     static void run_test(uuid::console::Shell & shell, const std::string & command); // only for testing
@@ -104,6 +105,10 @@ class EMSESP {
 #endif
 
     static bool        process_telegram(std::shared_ptr<const Telegram> telegram);
+    static bool        dispatch_telegram(std::shared_ptr<const Telegram> telegram, EMSdevice *& emsdevice);
+#ifdef EMSESP_STANDALONE
+    static bool dispatch_telegram_scan(std::shared_ptr<const Telegram> telegram, EMSdevice *& emsdevice); // old lookup, for benchmarking
+#endif
     static std::string pretty_telegram(std::shared_ptr<const Telegram> telegram);
 
     static void send_read_request(const uint16_t type_id, const uint8_t dest, const uint8_t offset = 0, const uint8_t length = 0, const bool front = false);
@@ -129,6 +134,7 @@ class EMSESP {
     static void show_device_values(uuid::console::Shell & shell);
     static void show_sensor_values(uuid::console::Shell & shell);
     static void dump_all_values(uuid::console::Shell & shell);
+    static void add_all_devices();
 
     static void show_devices(uuid::console::Shell & shell);
     static void show_ems(uuid::console::Shell & shell);
@@ -169,6 +175,10 @@ class EMSESP {
         response_id_ = id;
     }
 
+    static void read_next(bool next) {
+        read_next_ = next;
+    }
+
     static bool wait_validate() {
         return (wait_validate_ != 0);
     }
@@ -230,13 +240,20 @@ class EMSESP {
   private:
     static std::string device_tostring(const uint8_t device_id);
     static void        process_UBADevices(std::shared_ptr<const Telegram> telegram);
+    static void        index_devices();
+    static EMSdevice * find_device(const uint8_t device_id);
     static void        process_version(std::shared_ptr<const Telegram> telegram);
     static void        publish_response(std::shared_ptr<const Telegram> telegram);
     static void        publish_all_loop();
+    static void        publish_device_topic(const std::string & topic, const JsonObjectConst payload, const bool changed_only);
+    static void        ha_discovery_loop();
     static bool        command_commands(uint8_t device_type, JsonObject output, const int8_t id);
     static bool        command_entities(uint8_t device_type, JsonObject output, const int8_t id);
 
     static constexpr uint32_t EMS_FETCH_FREQUENCY = 60000; // check every minute
+
+    static constexpr uint8_t HA_DISCOVERY_MAX_PER_LOOP = 4;  // max number of HA configs to create in one loop
+    static constexpr uint8_t HA_DISCOVERY_QUEUE_MAX    = 20; // only add HA configs while the MQTT queue is shorter than this
     static constexpr uint8_t  EMS_WAIT_KM_TIMEOUT = 60;    // wait one minute
 
     struct Device_record {
@@ -255,7 +272,9 @@ class EMSESP {
     static uint16_t response_id_;
     static bool     tap_water_active_;
     static uint8_t  publish_all_idx_;
+    static uint8_t  ha_discovery_idx_; // next device in emsdevices to create HA configs for
     static uint8_t  unique_id_count_;
+    static uint8_t  device_lookup_[0x80]; // position+1 in emsdevices of the first device with this device_id, 0 if none
     static bool     trace_raw_;
     static uint16_t wait_validate_;
     static bool     wait_km_;
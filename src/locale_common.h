@@ -43,6 +43,8 @@ MAKE_WORD(restart)
 MAKE_WORD(format)
 MAKE_WORD(raw)
 MAKE_WORD(watch)
+MAKE_WORD(capture)
+MAKE_WORD(perf)
 MAKE_WORD(syslog)
 MAKE_WORD(send)
 MAKE_WORD(telegram)
@@ -271,6 +273,9 @@ MAKE_ENUM_FIXED(list_sensortype, "none", "digital in", "counter", "adc", "timer"
 // watch
 MAKE_ENUM_FIXED(list_watch, "off", "on", "raw", "unknown")
 
+// capture
+MAKE_ENUM_FIXED(list_capture, "off", "on", "clear", "save")
+
 /*
  * The rest below are Enums and generated from translations lists
  */
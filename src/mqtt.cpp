@@ -46,8 +46,11 @@ uint8_t     Mqtt::discovery_type_;
 bool        Mqtt::send_response_;
 bool        Mqtt::publish_single_;
 bool        Mqtt::publish_single2cmd_;
+bool        Mqtt::publish_changed_;
 
 std::vector<Mqtt::MQTTSubFunction> Mqtt::mqtt_subfunctions_;
+std::vector<Mqtt::MQTTSubIndex>    Mqtt::mqtt_subindex_;
+std::vector<std::string>           Mqtt::ha_dev_configs_;
 
 uint32_t Mqtt::mqtt_publish_fails_ = 0;
 bool     Mqtt::connecting_         = false;
@@ -58,8 +61,7 @@ uint8_t  Mqtt::connectcount_       = 0;
 uint32_t Mqtt::mqtt_message_id_    = 0;
 char     will_topic_[Mqtt::MQTT_TOPIC_MAX_SIZE]; // because MQTT library keeps only char pointer
 
-std::string Mqtt::lasttopic_    = "";
-std::string Mqtt::lastpayload_  = "";
+uint32_t    Mqtt::lastpublish_hash_ = 0;
 std::string Mqtt::lastresponse_ = "";
 
 // Home Assistant specific
@@ -81,19 +83,21 @@ uuid::log::Logger Mqtt::logger_{F_(mqtt), uuid::log::Facility::DAEMON};
 void Mqtt::subscribe(const uint8_t device_type, const std::string & topic, mqtt_sub_function_p cb) {
     // check if we already have the topic subscribed for this specific device type, if so don't add it again
     // add the function (in case its not there) and quit because it already exists
-    if (!mqtt_subfunctions_.empty()) {
-        for (auto & mqtt_subfunction : mqtt_subfunctions_) {
-            if ((mqtt_subfunction.device_type_ == device_type) && (strcmp(mqtt_subfunction.topic_.c_str(), topic.c_str()) == 0)) {
-                if (cb) {
-                    mqtt_subfunction.mqtt_subfunction_ = cb;
-                }
-                return; // exit - don't add
+    uint32_t hash = topic_hash(topic.c_str());
+    auto it = std::lower_bound(mqtt_subindex_.begin(), mqtt_subindex_.end(), hash, [](const MQTTSubIndex & entry, const uint32_t h) { return entry.hash < h; });
+    for (; it != mqtt_subindex_.end() && it->hash == hash; it++) {
+        auto & mqtt_subfunction = mqtt_subfunctions_[it->pos];
+        if ((mqtt_subfunction.device_type_ == device_type) && (mqtt_subfunction.topic_ == topic)) {
+            if (cb) {
+                mqtt_subfunction.mqtt_subfunction_ = cb;
             }
+            return; // exit - don't add
         }
     }
 
     // register in our libary with the callback function.
     // We store the original topic string without base
+    mqtt_subindex_.insert(it, {hash, (uint16_t)mqtt_subfunctions_.size()}); // after any with the same hash
     mqtt_subfunctions_.emplace_back(device_type, std::move(topic), std::move(cb));
 
     if (!enabled() || !connected()) {
@@ -237,23 +241,26 @@ void Mqtt::on_message(const char * topic, const uint8_t * payload, size_t len) {
     }
 
     // for misconfigured mqtt servers and publish2command ignore echos
-    if (publish_single_ && publish_single2cmd_ && lasttopic_ == topic && lastpayload_ == message) {
+    if (publish_single_ && publish_single2cmd_ && lastpublish_hash_ && lastpublish_hash_ == topic_hash(topic, message)) {
         LOG_DEBUG("Received echo message %s: %s", topic, message);
         return;
     }
 
-    // check first against any of our subscribed topics
-    for (const auto & mf : mqtt_subfunctions_) {
-        // add the base back
-        char full_topic[MQTT_TOPIC_MAX_SIZE];
-        snprintf(full_topic, sizeof(full_topic), "%s/%s", Mqtt::base().c_str(), mf.topic_.c_str());
-
-        if ((!strcmp(topic, full_topic)) && (mf.mqtt_subfunction_)) {
-            if (!(mf.mqtt_subfunction_)(message)) {
-                LOG_ERROR("error: invalid payload %s for this topic %s", message, topic);
-                Mqtt::queue_publish("response", "error: invalid data");
+    // check first against any of our subscribed topics, which are stored without the base
+    const std::string & base = Mqtt::base();
+    if (!strncmp(topic, base.c_str(), base.length()) && topic[base.length()] == '/') {
+        const char * short_topic = topic + base.length() + 1;
+        uint32_t     hash        = topic_hash(short_topic);
+        auto it = std::lower_bound(mqtt_subindex_.begin(), mqtt_subindex_.end(), hash, [](const MQTTSubIndex & entry, const uint32_t h) { return entry.hash < h; });
+        for (; it != mqtt_subindex_.end() && it->hash == hash; it++) {
+            const auto & mf = mqtt_subfunctions_[it->pos];
+            if ((mf.topic_ == short_topic) && (mf.mqtt_subfunction_)) {
+                if (!(mf.mqtt_subfunction_)(message)) {
+                    LOG_ERROR("error: invalid payload %s for this topic %s", message, topic);
+                    Mqtt::queue_publish("response", "error: invalid data");
+                }
+                return;
             }
-            return;
         }
     }
 
@@ -314,8 +321,10 @@ void Mqtt::show_topic_handlers(uuid::console::Shell & shell, const uint8_t devic
 }
 
 // called when an MQTT Publish ACK is received
-void Mqtt::on_publish(uint16_t packetId) const {
+// broker acknowledged a QoS 1 or 2 packet
+void Mqtt::on_publish(uint16_t packetId) {
     LOG_DEBUG("Packet %d sent successful", packetId);
+    Perf::mqtt_acked(packetId);
 }
 
 // called when MQTT settings have changed via the Web forms
@@ -340,6 +349,7 @@ void Mqtt::load_settings() {
         nested_format_      = mqttSettings.nested_format;
         publish_single_     = mqttSettings.publish_single;
         publish_single2cmd_ = mqttSettings.publish_single2cmd;
+        publish_changed_    = mqttSettings.publish_changed;
         send_response_      = mqttSettings.send_response;
         discovery_prefix_   = mqttSettings.discovery_prefix.c_str();
         entity_format_      = mqttSettings.entity_format;
@@ -358,6 +368,7 @@ void Mqtt::load_settings() {
     // create basename from the mqtt base
     // and replacing all / with underscores, in case it's a path
     mqtt_basename_ = mqtt_base_;
+    ha_dev_configs_.clear(); // the basename is part of them
     std::replace(mqtt_basename_.begin(), mqtt_basename_.end(), '/', '_');
 }
 
@@ -580,7 +591,9 @@ void Mqtt::ha_status() {
 
 // add sub or pub task to the queue.
 // the base is not included in the topic
-bool Mqtt::queue_message(const uint8_t operation, const std::string & topic, const std::string & payload, const bool retain) {
+// if json is set it's measured and serialized straight into the MQTT packet, instead of the payload string
+bool Mqtt::queue_message(const uint8_t operation, const std::string & topic, const std::string & payload, const bool retain, JsonObjectConst json) {
+    uint32_t start_us = Perf::now_us();
     if (topic == "response" && operation == Operation::PUBLISH) {
         lastresponse_ = payload;
         if (!send_response_) {
@@ -621,8 +634,19 @@ bool Mqtt::queue_message(const uint8_t operation, const std::string & topic, con
     }
 
     if (operation == Operation::PUBLISH) {
-        packet_id = mqttClient_->publish(fulltopic, mqtt_qos_, retain, payload.c_str());
+        if (json.isNull()) {
+            packet_id = mqttClient_->publish(fulltopic, mqtt_qos_, retain, payload.c_str());
+            if (publish_single_ && publish_single2cmd_) {
+                lastpublish_hash_ = topic_hash(fulltopic, payload.c_str()); // remember it, so we can ignore the echo
+            }
+        } else {
+            espMqttClientTypes::PayloadWriter writer = [json](uint8_t * data, size_t length) { serializeJson(json, data, length); };
+            packet_id                                = mqttClient_->publish(fulltopic, mqtt_qos_, retain, writer, measureJson(json));
+        }
         mqtt_message_id_++;
+        if (packet_id && mqtt_qos_) {
+            Perf::mqtt_queued(packet_id);
+        }
         LOG_DEBUG("Publishing topic '%s', pid %d", fulltopic, packet_id);
     } else if (operation == Operation::SUBSCRIBE) {
         packet_id = mqttClient_->subscribe(fulltopic, mqtt_qos_);
@@ -637,9 +661,25 @@ bool Mqtt::queue_message(const uint8_t operation, const std::string & topic, con
         mqtt_publish_fails_++;
     }
 #endif
+    Perf::add(Perf::MQTT_QUEUE, start_us);
     return (packet_id != 0);
 }
 
+// FNV-1a hash of the topic, and the payload if given
+uint32_t Mqtt::topic_hash(const char * topic, const char * payload) {
+    uint32_t hash = 2166136261UL;
+    while (*topic) {
+        hash = (hash ^ (uint8_t)*topic++) * 16777619UL;
+    }
+    if (payload != nullptr) {
+        hash = (hash ^ '\0') * 16777619UL; // separate the topic from the payload
+        while (*payload) {
+            hash = (hash ^ (uint8_t)*payload++) * 16777619UL;
+        }
+    }
+    return hash;
+}
+
 // add MQTT message to queue, payload is a string
 bool Mqtt::queue_publish_message(const std::string & topic, const std::string & payload, const bool retain) {
     return queue_message(Operation::PUBLISH, topic, payload, retain);
@@ -690,13 +730,18 @@ bool Mqtt::queue_publish_retain(const std::string & topic, const JsonObjectConst
 }
 
 bool Mqtt::queue_publish_retain(const char * topic, const JsonObjectConst payload, const bool retain) {
-    if (payload.size()) {
+    if (!payload.size()) {
+        return false;
+    }
+    // the response is also kept as a string
+    if (!strcmp(topic, "response")) {
         std::string payload_text;
         payload_text.reserve(measureJson(payload) + 1);
         serializeJson(payload, payload_text); // convert json to string
         return queue_publish_message(topic, payload_text, retain);
     }
-    return false;
+    // serialize directly into the MQTT packet, so we don't need a copy of the payload
+    return queue_message(Operation::PUBLISH, topic, "", retain, payload);
 }
 
 // publish empty payload to remove the topic
@@ -714,37 +759,63 @@ bool Mqtt::queue_ha(const char * topic, const JsonObjectConst payload) {
         return false;
     }
 
-    std::string payload_text;
-    payload_text.reserve(measureJson(payload) + 1);
-    serializeJson(payload, payload_text); // convert json to string
-
-    return queue_publish_message(Mqtt::discovery_prefix() + topic, payload_text, true); // with retain true
+    // serialize directly into the MQTT packet, so we don't need a copy of the payload
+    return queue_message(Operation::PUBLISH, Mqtt::discovery_prefix() + topic, "", true, payload); // with retain true
 }
 
-// create's a ha sensor config topic from a device value object
-// and also takes a flag (create_device_config) used to also create the main HA device config. This is only needed for one entity
-bool Mqtt::publish_ha_sensor_config(DeviceValue & dv, const char * model, const char * brand, const bool remove, const bool create_device_config) {
-    JsonDocument dev_json;
+// adds the ids (discovery indentifiers) and name of a device type to the "dev" section
+void Mqtt::add_ha_dev(JsonObject dev_json, const uint8_t device_type) {
+    if (device_type == EMSdevice::DeviceType::SYSTEM) {
+        dev_json["name"] = Mqtt::basename();
+        JsonArray ids    = dev_json["ids"].to<JsonArray>();
+        ids.add(Mqtt::basename());
+        return;
+    }
 
-    // always create the ids (discovery indentifiers)
-    // with the name always
-    // and the manufacturer and model if we're creating the device config for the first entity
     JsonArray ids = dev_json["ids"].to<JsonArray>();
     char      ha_device[40];
-    auto      device_type_name = EMSdevice::device_type_2_device_name(dv.device_type);
+    auto      device_type_name = EMSdevice::device_type_2_device_name(device_type);
     snprintf(ha_device, sizeof(ha_device), "%s-%s", Mqtt::basename().c_str(), device_type_name);
     ids.add(ha_device);
 
-    auto cap_name = strdup(device_type_name);
-    Helpers::CharToUpperUTF8(cap_name); // capitalize first letter
-    dev_json["name"] = Mqtt::basename() + " " + cap_name;
-    free(cap_name);
+    char   cap_name[60];
+    size_t pos = Mqtt::basename().length() + 1;
+    snprintf(cap_name, sizeof(cap_name), "%s %s", Mqtt::basename().c_str(), device_type_name);
+    if (pos + 1 < sizeof(cap_name)) {
+        Helpers::CharToUpperUTF8(cap_name + pos); // capitalize first letter
+    }
+    dev_json["name"] = cap_name;
+}
+
+// the serialized "dev" section for the entities of a device type, built once
+const char * Mqtt::ha_dev_config(const uint8_t device_type) {
+    if (ha_dev_configs_.size() <= device_type) {
+        ha_dev_configs_.resize(device_type + 1);
+    }
+
+    std::string & dev_config = ha_dev_configs_[device_type];
+    if (dev_config.empty()) {
+        JsonDocument dev_json;
+        add_ha_dev(dev_json.to<JsonObject>(), device_type);
+        serializeJson(dev_json, dev_config);
+    }
 
-    // create only once per category
+    return dev_config.c_str();
+}
+
+// create's a ha sensor config topic from a device value object
+// and also takes a flag (create_device_config) used to also create the main HA device config. This is only needed for one entity
+bool Mqtt::publish_ha_sensor_config(DeviceValue & dv, const char * model, const char * brand, const bool remove, const bool create_device_config) {
+    // add the manufacturer and model if we're creating the device config for the first entity
+    // all the other entities use the cached dev section
+    std::string dev_config;
     if (create_device_config) {
+        JsonDocument dev_json;
+        add_ha_dev(dev_json.to<JsonObject>(), dv.device_type);
         dev_json["mf"]         = brand;
         dev_json["mdl"]        = model;
         dev_json["via_device"] = Mqtt::basename();
+        serializeJson(dev_json, dev_config);
     }
 
     // calculate the min and max
@@ -771,20 +842,26 @@ bool Mqtt::publish_ha_sensor_config(DeviceValue & dv, const char * model, const
                                     dv_set_min,
                                     dv_set_max,
                                     dv.numeric_operator,
-                                    dev_json.as<JsonObject>());
+                                    create_device_config ? dev_config.c_str() : ha_dev_config(dv.device_type));
 }
 
 // publish HA sensor for System using the heartbeat tag
 bool Mqtt::publish_system_ha_sensor_config(uint8_t type, const char * name, const char * entity, const uint8_t uom) {
-    JsonDocument doc;
-    JsonObject   dev_json = doc["dev"].to<JsonObject>();
-
-    dev_json["name"] = Mqtt::basename();
-    JsonArray ids    = dev_json["ids"].to<JsonArray>();
-    ids.add(Mqtt::basename());
-
-    return publish_ha_sensor_config(
-        type, DeviceValueTAG::TAG_HEARTBEAT, name, name, EMSdevice::DeviceType::SYSTEM, entity, uom, false, false, nullptr, 0, 0, 0, 0, dev_json);
+    return publish_ha_sensor_config(type,
+                                    DeviceValueTAG::TAG_HEARTBEAT,
+                                    name,
+                                    name,
+                                    EMSdevice::DeviceType::SYSTEM,
+                                    entity,
+                                    uom,
+                                    false,
+                                    false,
+                                    nullptr,
+                                    0,
+                                    0,
+                                    0,
+                                    0,
+                                    ha_dev_config(EMSdevice::DeviceType::SYSTEM));
 }
 
 // MQTT discovery configs
@@ -804,7 +881,7 @@ bool Mqtt::publish_ha_sensor_config(uint8_t               type,        // EMSdev
                                     const int16_t         dv_set_min,
                                     const uint32_t        dv_set_max,
                                     const int8_t          num_op,
-                                    const JsonObjectConst dev_json) {
+                                    const char * const    dev_json) { // serialized dev section
     // ignore if name (fullname) is empty
     if (!fullname || !en_name) {
         return false;
@@ -980,16 +1057,16 @@ bool Mqtt::publish_ha_sensor_config(uint8_t               type,        // EMSdev
     }
 
     // friendly name = <tag> <name>
-    char   ha_name[70];
-    char * F_name = strdup(fullname);
-    Helpers::CharToUpperUTF8(F_name); // capitalize first letter
+    char ha_name[70];
     if (has_tag) {
         // exclude heartbeat tag
-        snprintf(ha_name, sizeof(ha_name), "%s %s", EMSdevice::tag_to_string(tag), F_name);
+        int len = snprintf(ha_name, sizeof(ha_name), "%s ", EMSdevice::tag_to_string(tag));
+        strlcpy(ha_name + len, fullname, sizeof(ha_name) - len);
+        Helpers::CharToUpperUTF8(ha_name + len); // capitalize first letter
     } else {
-        snprintf(ha_name, sizeof(ha_name), "%s", F_name); // no tag
+        strlcpy(ha_name, fullname, sizeof(ha_name)); // no tag
+        Helpers::CharToUpperUTF8(ha_name);
     }
-    free(F_name); // very important!
     doc["name"] = ha_name;
 
 
@@ -1030,7 +1107,9 @@ bool Mqtt::publish_ha_sensor_config(uint8_t               type,        // EMSdev
                 snprintf(sample_val, sizeof(sample_val), "'%s'", Helpers::render_boolean(result, false));
             }
         }
-        doc["val_tpl"] = (std::string) "{{" + val_obj + " if " + val_cond + " else " + sample_val + "}}";
+        char val_tpl[350];
+        snprintf(val_tpl, sizeof(val_tpl), "{{%s if %s else %s}}", val_obj, val_cond, sample_val);
+        doc["val_tpl"] = val_tpl;
 
         // add the dev json object to the end, not for commands
         add_ha_sections_to_doc(nullptr, stat_t, doc, false, val_cond); // no name, since the "dev" has already been adde
@@ -1046,7 +1125,7 @@ bool Mqtt::publish_ha_sensor_config(uint8_t               type,        // EMSdev
         add_ha_uom(doc.as<JsonObject>(), type, uom, entity); // add the UoM, device and state class
     }
 
-    doc["dev"] = dev_json;
+    doc["dev"] = serialized(dev_json); // copied as it is, without parsing it again
 
     return queue_ha(topic, doc.as<JsonObject>());
 }
@@ -1307,8 +1386,8 @@ void Mqtt::add_ha_sections_to_doc(const char *   name,
     }
 
     // adds "availability" section to HA Discovery config
-    JsonArray    avty = config["avty"].to<JsonArray>();
-    JsonDocument avty_json;
+    JsonArray  avty = config["avty"].to<JsonArray>();
+    JsonObject avty_json;
 
     const char * tpl_draft = "{{'online' if %s else 'offline'}}";
 
@@ -1323,28 +1402,25 @@ void Mqtt::add_ha_sections_to_doc(const char *   name,
     // skip conditional Jinja2 templates if not home assistant
     if (discovery_type() == discoveryType::HOMEASSISTANT) {
         // condition 1
-        avty_json.clear();
+        avty_json      = avty.add<JsonObject>();
         avty_json["t"] = state_t;
         snprintf(tpl, sizeof(tpl), tpl_draft, cond1 == nullptr ? "value is defined" : cond1);
         avty_json["val_tpl"] = tpl;
-        avty.add(avty_json); // returns 0 if no mem
 
         // condition 2
         if (cond2 != nullptr) {
-            avty_json.clear();
+            avty_json      = avty.add<JsonObject>();
             avty_json["t"] = state_t;
             snprintf(tpl, sizeof(tpl), tpl_draft, cond2);
             avty_json["val_tpl"] = tpl;
-            avty.add(avty_json); // returns 0 if no mem
         }
 
         // negative condition
         if (negcond != nullptr) {
-            avty_json.clear();
+            avty_json      = avty.add<JsonObject>();
             avty_json["t"] = state_t;
             snprintf(tpl, sizeof(tpl), "{{'offline' if %s else 'online'}}", negcond);
             avty_json["val_tpl"] = tpl;
-            avty.add(avty_json); // returns 0 if no mem
         }
 
         config["avty_mode"] = "all";
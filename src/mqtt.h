@@ -61,6 +61,7 @@ class Mqtt {
     static void on_connect();
     static void on_disconnect(espMqttClientTypes::DisconnectReason reason);
     static void on_message(const char * topic, const uint8_t * payload, size_t len);
+    static void on_publish(uint16_t packetId);
     static void subscribe(const uint8_t device_type, const std::string & topic, mqtt_sub_function_p cb);
     static void subscribe(const std::string & topic);
     static void resubscribe();
@@ -91,7 +92,7 @@ class Mqtt {
                                          const int16_t         dv_set_min,
                                          const uint32_t        dv_set_max,
                                          const int8_t          num_op,
-                                         const JsonObjectConst dev_json);
+                                         const char * const    dev_json);
 
     static bool publish_system_ha_sensor_config(uint8_t type, const char * name, const char * entity, const uint8_t uom);
     static bool publish_ha_climate_config(const uint8_t tag, const bool has_roomtemp, const bool remove = false, const int16_t min = 5, const uint32_t max = 30);
@@ -121,7 +122,7 @@ class Mqtt {
         mqtt_enabled_ = mqtt_enabled;
     }
 
-    static std::string base() {
+    static const std::string & base() {
         return mqtt_base_;
     }
 
@@ -191,6 +192,15 @@ class Mqtt {
         publish_single_ = publish_single;
     }
 
+    // on change only publish the values that have changed, can't be used with HA discovery or single topics
+    static bool publish_changed() {
+        return mqtt_enabled_ && publish_changed_ && !ha_enabled_ && !publish_single_;
+    }
+
+    static void publish_changed(bool publish_changed) {
+        publish_changed_ = publish_changed;
+    }
+
     static bool ha_enabled() {
         return mqtt_enabled_ && ha_enabled_;
     }
@@ -237,13 +247,15 @@ class Mqtt {
     static MqttClient * mqttClient_;
     static uint32_t     mqtt_message_id_;
 
-    static bool queue_message(const uint8_t operation, const std::string & topic, const std::string & payload, const bool retain);
+    static bool queue_message(const uint8_t     operation,
+                              const std::string & topic,
+                              const std::string & payload,
+                              const bool          retain,
+                              JsonObjectConst     json = JsonObjectConst());
     static bool queue_publish_message(const std::string & topic, const std::string & payload, const bool retain);
     static void queue_subscribe_message(const std::string & topic);
     static void queue_unsubscribe_message(const std::string & topic);
 
-    void on_publish(uint16_t packetId) const;
-
     // function handlers for MQTT subscriptions
     struct MQTTSubFunction {
         uint8_t             device_type_;      // which device type, from DeviceType::
@@ -259,6 +271,21 @@ class Mqtt {
 
     static std::vector<MQTTSubFunction> mqtt_subfunctions_; // list of mqtt subscribe callbacks for all devices
 
+    // index into mqtt_subfunctions_, sorted by the hash of the topic without the base
+    // entries with the same hash are kept in the order they were added
+    struct MQTTSubIndex {
+        uint32_t hash;
+        uint16_t pos; // position in mqtt_subfunctions_
+    };
+    static std::vector<MQTTSubIndex> mqtt_subindex_;
+
+    // the serialized HA "dev" section of each device type, the same for all its entities
+    static std::vector<std::string> ha_dev_configs_;
+    static const char *             ha_dev_config(const uint8_t device_type);
+    static void                     add_ha_dev(JsonObject dev_json, const uint8_t device_type);
+
+    static uint32_t topic_hash(const char * topic, const char * payload = nullptr);
+
     // uint32_t last_mqtt_poll_          = 0;
     uint32_t last_publish_boiler_     = 0;
     uint32_t last_publish_thermostat_ = 0;
@@ -276,8 +303,7 @@ class Mqtt {
     static uint8_t  connectcount_;
     static bool     ha_climate_reset_;
 
-    static std::string lasttopic_;
-    static std::string lastpayload_;
+    static uint32_t    lastpublish_hash_; // hash of the last published topic and payload, to spot echos
     static std::string lastresponse_;
 
     // settings, copied over
@@ -301,6 +327,7 @@ class Mqtt {
     static uint8_t     discovery_type_;
     static bool        publish_single_;
     static bool        publish_single2cmd_;
+    static bool        publish_changed_;
     static bool        send_response_;
 };
 
@@ -0,0 +1,132 @@
+/*
+ * EMS-ESP - https://github.com/emsesp/EMS-ESP
+ * Copyright 2020-2024  Paul Derbyshire
+ * 
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "perf.h"
+#include "emsdevice.h"
+
+namespace emsesp {
+
+static_assert(EMSdevice::DeviceType::UNKNOWN < 24, "too many device types for Perf");
+
+static const char * const stage_names[Perf::STAGES] = {"uart", "rx queue", "process", "publish wait", "publish build", "mqtt queue", "mqtt ack"};
+
+LatencyStat Perf::stats_[Perf::STAGES];
+uint32_t    Perf::changed_us_[Perf::MAX_DEVICE_TYPES];
+uint16_t    Perf::ack_ids_[Perf::MAX_PENDING_ACKS];
+uint32_t    Perf::ack_us_[Perf::MAX_PENDING_ACKS];
+uint8_t     Perf::ack_head_ = 0;
+uint8_t     Perf::ack_tail_ = 0;
+
+void LatencyStat::reset() {
+    *this = LatencyStat();
+}
+
+uint32_t LatencyStat::p99() const {
+    if (!count_) {
+        return 0;
+    }
+    uint32_t rank = count_ - count_ / 100; // the sample 99% of all are at or below
+    uint32_t seen = 0;
+    for (uint8_t bucket = 0; bucket < 32; bucket++) {
+        seen += buckets_[bucket];
+        if (seen >= rank) {
+            uint32_t upper = bucket < 31 ? (2UL << bucket) - 1 : UINT32_MAX;
+            return std::min(upper, max_);
+        }
+    }
+    return max_;
+}
+
+void Perf::value_changed(uint8_t device_type) {
+    if (device_type < MAX_DEVICE_TYPES && !changed_us_[device_type]) {
+        changed_us_[device_type] = now_us() | 1; // never 0
+    }
+}
+
+void Perf::published(uint8_t device_type) {
+    if (device_type < MAX_DEVICE_TYPES && changed_us_[device_type]) {
+        add(PUBLISH_WAIT, changed_us_[device_type]);
+        changed_us_[device_type] = 0;
+    }
+}
+
+void Perf::mqtt_queued(uint16_t packet_id) {
+    uint8_t next = (ack_head_ + 1) % MAX_PENDING_ACKS;
+    if (next == ack_tail_) {
+        ack_tail_ = (ack_tail_ + 1) % MAX_PENDING_ACKS; // forget the oldest
+    }
+    ack_ids_[ack_head_] = packet_id;
+    ack_us_[ack_head_]  = now_us();
+    ack_head_           = next;
+}
+
+void Perf::mqtt_acked(uint16_t packet_id) {
+    while (ack_tail_ != ack_head_) {
+        uint8_t tail = ack_tail_;
+        ack_tail_    = (ack_tail_ + 1) % MAX_PENDING_ACKS;
+        if (ack_ids_[tail] == packet_id) {
+            add(MQTT_ACK, ack_us_[tail]);
+            return;
+        }
+    }
+}
+
+void Perf::reset() {
+    for (auto & stat : stats_) {
+        stat.reset();
+    }
+    for (auto & changed : changed_us_) {
+        changed = 0;
+    }
+    ack_head_ = ack_tail_ = 0;
+}
+
+void Perf::show(uuid::console::Shell & shell) {
+    shell.printfln("Latency per stage (us):");
+    shell.printfln(" %-14s %8s %8s %8s %8s %8s", "stage", "count", "min", "avg", "p99", "max");
+    for (uint8_t i = 0; i < STAGES; i++) {
+        const auto & s = stats_[i];
+        shell.printfln(" %-14s %8lu %8lu %8lu %8lu %8lu",
+                       stage_names[i],
+                       (unsigned long)s.count(),
+                       (unsigned long)s.min(),
+                       (unsigned long)s.avg(),
+                       (unsigned long)s.p99(),
+                       (unsigned long)s.max());
+    }
+}
+
+void Perf::info(JsonObject output) {
+    for (uint8_t i = 0; i < STAGES; i++) {
+        const auto & s = stats_[i];
+        if (!s.count()) {
+            continue;
+        }
+        char name[40];
+        snprintf(name, sizeof(name), "%s count", stage_names[i]);
+        output[name] = s.count();
+        snprintf(name, sizeof(name), "%s min (us)", stage_names[i]);
+        output[name] = s.min();
+        snprintf(name, sizeof(name), "%s avg (us)", stage_names[i]);
+        output[name] = s.avg();
+        snprintf(name, sizeof(name), "%s p99 (us)", stage_names[i]);
+        output[name] = s.p99();
+    }
+}
+
+} // namespace emsesp
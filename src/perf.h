@@ -0,0 +1,134 @@
+/*
+ * EMS-ESP - https://github.com/emsesp/EMS-ESP
+ * Copyright 2020-2024  Paul Derbyshire
+ * 
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef EMSESP_PERF_H
+#define EMSESP_PERF_H
+
+#include <Arduino.h>
+#include <ArduinoJson.h>
+
+#include <uuid/console.h>
+
+#ifdef EMSESP_STANDALONE
+#include <chrono>
+#endif
+
+namespace emsesp {
+
+// min/avg/max and an approximate p99 of a latency in us
+// the p99 comes from power of 2 buckets, so it is the upper bound of its bucket
+class LatencyStat {
+  public:
+    void add(uint32_t us) {
+        count_++;
+        total_ += us;
+        if (us < min_) {
+            min_ = us;
+        }
+        if (us > max_) {
+            max_ = us;
+        }
+        uint8_t bucket = 0;
+        while (us >>= 1) {
+            bucket++;
+        }
+        buckets_[bucket]++;
+    }
+
+    void reset();
+
+    uint32_t count() const {
+        return count_;
+    }
+    uint32_t min() const {
+        return count_ ? min_ : 0;
+    }
+    uint32_t max() const {
+        return max_;
+    }
+    uint32_t avg() const {
+        return count_ ? (uint32_t)(total_ / count_) : 0;
+    }
+    uint32_t p99() const;
+
+  private:
+    uint32_t count_ = 0;
+    uint32_t min_   = UINT32_MAX;
+    uint32_t max_   = 0;
+    uint64_t total_ = 0;
+    uint32_t buckets_[32]{};
+};
+
+// timestamp probes along the path of a telegram, from the UART to the MQTT broker
+// each stage is only written from one task: UART from the UART task, the others from the main loop
+class Perf {
+  public:
+    enum Stage : uint8_t {
+        UART,          // UART break until the frame is in the Rx queue
+        RX_QUEUE,      // waiting in the Rx queue until RxService::loop takes it
+        PROCESS,       // validating the frame and running the telegram handler
+        PUBLISH_WAIT,  // first changed value until publish_device_values() for the device type
+        PUBLISH_BUILD, // publish_device_values(), building the JSON and queuing it
+        MQTT_QUEUE,    // Mqtt::queue_message(), serializing into the MQTT outbox
+        MQTT_ACK,      // queued until the broker acknowledged it, only with QoS 1 and 2
+        STAGES
+    };
+
+    static uint32_t now_us() {
+#ifndef EMSESP_STANDALONE
+        return (uint32_t)esp_timer_get_time();
+#else
+        return (uint32_t)std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now().time_since_epoch()).count();
+#endif
+    }
+
+    static void add(Stage stage, uint32_t since_us) {
+        stats_[stage].add(now_us() - since_us);
+    }
+
+    static const LatencyStat & stat(Stage stage) {
+        return stats_[stage];
+    }
+
+    // PUBLISH_WAIT, remembers when a device type first had a changed value since its last publish
+    static void value_changed(uint8_t device_type);
+    static void published(uint8_t device_type);
+
+    // MQTT_ACK, the broker acknowledges packets in the order they were sent
+    static void mqtt_queued(uint16_t packet_id);
+    static void mqtt_acked(uint16_t packet_id);
+
+    static void reset();
+    static void show(uuid::console::Shell & shell);
+    static void info(JsonObject output);
+
+  private:
+    static constexpr uint8_t MAX_DEVICE_TYPES = 24;
+    static constexpr uint8_t MAX_PENDING_ACKS = 16;
+
+    static LatencyStat stats_[STAGES];
+    static uint32_t    changed_us_[MAX_DEVICE_TYPES]; // 0 if there is no change waiting
+    static uint16_t    ack_ids_[MAX_PENDING_ACKS];
+    static uint32_t    ack_us_[MAX_PENDING_ACKS];
+    static uint8_t     ack_head_;
+    static uint8_t     ack_tail_;
+};
+
+} // namespace emsesp
+
+#endif
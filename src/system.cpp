@@ -252,6 +252,47 @@ bool System::command_watch(const char * value, const int8_t id) {
     return false;
 }
 
+// records the raw telegrams, value is off, on, clear, save or the size of the ring in bytes
+// the capture is downloaded from /rest/getCapture, save writes it to the filesystem
+bool System::command_capture(const char * value, const int8_t id) {
+    auto &  capture = EMSESP::rxservice_.capture();
+    uint8_t c       = 0xff;
+    if (Helpers::value2enum(value, c, FL_(list_capture))) {
+        switch (c) {
+        case 0:
+            capture.stop();
+            return true;
+        case 1:
+            return capture.active() || capture.start(EMSESP_DEFAULT_CAPTURE_SIZE);
+        case 2:
+            capture.clear();
+            return true;
+        case 3: {
+#ifndef EMSESP_STANDALONE
+            if (!capture.active()) {
+                return false;
+            }
+            auto snapshot = capture.snapshot();
+            File file     = LittleFS.open(EMSESP_CAPTURE_FILE, "w");
+            if (!file) {
+                return false;
+            }
+            bool ok = file.write(snapshot.data(), snapshot.size()) == snapshot.size();
+            file.close();
+            LOG_INFO("Saved %d telegrams of the bus capture to %s", capture.frames(), EMSESP_CAPTURE_FILE);
+            return ok;
+#else
+            return false;
+#endif
+        }
+        default:
+            return false;
+        }
+    }
+    int size = Helpers::atoint(value);
+    return size > 0 && capture.start(size);
+}
+
 void System::store_nvs_values() {
     if (Command::find_command(EMSdevice::DeviceType::BOILER, 0, "nompower") != nullptr) {
         Command::call(EMSdevice::DeviceType::BOILER, "nompower", "-1"); // trigger a write
@@ -802,6 +843,7 @@ void System::commands_init() {
     // restart and watch (and test) are also exposed as Console commands
     Command::add(EMSdevice::DeviceType::SYSTEM, F_(restart), System::command_restart, FL_(restart_cmd), CommandFlag::ADMIN_ONLY);
     Command::add(EMSdevice::DeviceType::SYSTEM, F_(watch), System::command_watch, FL_(watch_cmd));
+    Command::add(EMSdevice::DeviceType::SYSTEM, F_(capture), System::command_capture, FL_(capture_cmd), CommandFlag::ADMIN_ONLY);
 
 #if defined(EMSESP_TEST)
     Command::add(EMSdevice::DeviceType::SYSTEM, ("test"), System::command_test, FL_(test_cmd));
@@ -1239,6 +1281,9 @@ bool System::command_info(const char * value, const int8_t id, JsonObject output
     node["partition"] = esp_ota_get_running_partition()->label;
 #endif
     node["reset reason"] = EMSESP::system_.reset_reason(0) + " / " + EMSESP::system_.reset_reason(1);
+    node["telegram pool used"]      = TelegramPool::used();
+    node["telegram pool max used"]  = TelegramPool::max_used();
+    node["telegram pool overflows"] = TelegramPool::heap_fallbacks();
 
 #ifndef EMSESP_STANDALONE
     // Network Status
@@ -1317,6 +1362,13 @@ bool System::command_info(const char * value, const int8_t id, JsonObject output
         node["MQTT queued"]        = Mqtt::publish_queued();
         node["MQTT publish fails"] = Mqtt::publish_fails();
         node["MQTT connects"]      = Mqtt::connect_count();
+        if (Mqtt::ha_enabled()) {
+            uint16_t created, total;
+            char     progress[40];
+            EMSESP::ha_discovery_progress(created, total);
+            snprintf(progress, sizeof(progress), "%d of %d configs published", created, total);
+            node["HA discovery"] = progress;
+        }
     }
     EMSESP::esp8266React.getMqttSettingsService()->read([&](MqttSettings & settings) {
         node["enabled"]                 = settings.enabled;
@@ -1340,6 +1392,7 @@ bool System::command_info(const char * value, const int8_t id, JsonObject output
         node["publish time sensor"]     = settings.publish_time_sensor;
         node["publish single"]          = settings.publish_single;
         node["publish2command"]         = settings.publish_single2cmd;
+        node["publish changed"]         = settings.publish_changed;
         node["send response"]           = settings.send_response;
     });
 
@@ -1395,12 +1448,32 @@ bool System::command_info(const char * value, const int8_t id, JsonObject output
         node["bus reads (tx)"]              = EMSESP::txservice_.telegram_read_count();
         node["bus writes (tx)"]             = EMSESP::txservice_.telegram_write_count();
         node["bus incomplete telegrams"]    = EMSESP::rxservice_.telegram_error_count();
+        node["bus telegrams assembled"]     = EMSESP::rxservice_.blocks_assembled();
+        node["bus rx queue max"]            = EMSESP::rxservice_.queue_high_water();
+        node["bus rx queue overruns"]       = EMSESP::rxservice_.queue_overruns();
+        node["bus tx queue high"]           = EMSESP::txservice_.queue_size(TxService::PRIORITY_HIGH);
+        node["bus tx queue user"]           = EMSESP::txservice_.queue_size(TxService::PRIORITY_USER);
+        node["bus tx queue fetch"]          = EMSESP::txservice_.queue_size(TxService::PRIORITY_FETCH);
+        node["bus tx reads coalesced"]      = EMSESP::txservice_.reads_coalesced();
+        node["bus tx writes superseded"]    = EMSESP::txservice_.writes_superseded();
+        node["bus fetches skipped"]         = EMSdevice::fetch_skipped();
+        node["bus load"]                    = EMSESP::rxservice_.bus_load().utilization(::millis());
+        node["bus load own"]                = EMSESP::rxservice_.bus_load().own_utilization(::millis());
+        node["bus tx deferred"]             = EMSESP::txservice_.pacer().deferred();
+        if (EMSESP::rxservice_.capture().active()) {
+            node["bus capture telegrams"] = EMSESP::rxservice_.capture().frames();
+            node["bus capture dropped"]   = EMSESP::rxservice_.capture().dropped();
+        }
         node["bus reads failed"]            = EMSESP::txservice_.telegram_read_fail_count();
         node["bus writes failed"]           = EMSESP::txservice_.telegram_write_fail_count();
         node["bus rx line quality"]         = EMSESP::rxservice_.quality();
         node["bus tx line quality"]         = (EMSESP::txservice_.read_quality() + EMSESP::txservice_.read_quality()) / 2;
     }
 
+    // Performance, latency of each stage from the UART to the MQTT broker
+    node = output["Performance Info"].to<JsonObject>();
+    Perf::info(node);
+
     // Settings
     node = output["Settings"].to<JsonObject>();
     EMSESP::webSettingsService.read([&](WebSettings & settings) {
@@ -1438,6 +1511,9 @@ bool System::command_info(const char * value, const int8_t id, JsonObject output
         node["analog enabled"]     = settings.analog_enabled;
         node["telnet enabled"]     = settings.telnet_enabled;
         node["max web log buffer"] = settings.weblog_buffer;
+        node["fetch interval min"] = settings.fetch_min;
+        node["fetch interval max"] = settings.fetch_max;
+        node["tx share"]           = settings.tx_share;
         node["web log buffer"]     = EMSESP::webLogService.num_log_messages();
     });
 
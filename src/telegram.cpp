@@ -58,6 +58,47 @@ uint8_t EMSbus::calculate_crc(const uint8_t * data, const uint8_t length) {
     return crc;
 }
 
+alignas(8) uint8_t TelegramPool::blocks_[TelegramPool::POOL_SIZE][TelegramPool::BLOCK_SIZE];
+uint64_t           TelegramPool::used_           = 0;
+uint8_t            TelegramPool::max_used_       = 0;
+uint32_t           TelegramPool::heap_fallbacks_ = 0;
+std::mutex         TelegramPool::mutex_;
+
+// take a free block from the pool, or from the heap if the pool is full
+void * TelegramPool::allocate(const size_t size) {
+    if (size <= BLOCK_SIZE) {
+        std::lock_guard<std::mutex> lock{mutex_};
+        if (~used_) {
+            uint8_t i = __builtin_ctzll(~used_); // first free block
+            used_ |= (1ULL << i);
+            uint8_t n = __builtin_popcountll(used_);
+            if (n > max_used_) {
+                max_used_ = n;
+            }
+            return blocks_[i];
+        }
+        heap_fallbacks_++;
+    }
+    return ::operator new(size);
+}
+
+// return a block to the pool, or to the heap if it didn't come from the pool
+void TelegramPool::deallocate(void * p) {
+    uint8_t * block = static_cast<uint8_t *>(p);
+    if (block >= &blocks_[0][0] && block < &blocks_[0][0] + sizeof(blocks_)) {
+        std::lock_guard<std::mutex> lock{mutex_};
+        used_ &= ~(1ULL << ((block - &blocks_[0][0]) / BLOCK_SIZE));
+        return;
+    }
+    ::operator delete(p);
+}
+
+// number of blocks in use
+uint8_t TelegramPool::used() {
+    std::lock_guard<std::mutex> lock{mutex_};
+    return __builtin_popcountll(used_);
+}
+
 // creates a telegram object
 // stores header in separate member objects and the rest in the message_data block
 Telegram::Telegram(const uint8_t   operation,
@@ -72,17 +113,15 @@ Telegram::Telegram(const uint8_t   operation,
     , dest(dest)
     , type_id(type_id)
     , offset(offset)
-    , message_length(message_length) {
-    // copy complete telegram data over, preventing buffer overflow
-    // faster than using std::move()
-    for (uint8_t i = 0; ((i < message_length) && (i < EMS_MAX_TELEGRAM_MESSAGE_LENGTH)); i++) {
-        message_data[i] = data[i];
-    }
+    , message_length(message_length)
+    , message_data(message_length > EMS_MAX_TELEGRAM_MESSAGE_LENGTH ? new uint8_t[message_length] : data_)
+    , block_(message_data != data_ ? message_data : nullptr) {
+    memcpy(message_data, data, message_length);
 }
 
 // returns telegram as data bytes in hex (excluding CRC)
 std::string Telegram::to_string() const {
-    uint8_t data[EMS_MAX_TELEGRAM_LENGTH];
+    uint8_t data[7 + EMS_MAX_BLOCK_LENGTH];
     uint8_t length = 0;
     data[0]        = this->src ^ RxService::ems_mask();
     data[3]        = this->offset;
@@ -126,25 +165,43 @@ std::string Telegram::to_string_message() const {
     return Helpers::data_to_hex(this->message_data, this->message_length);
 }
 
-// checks if we have an Rx telegram that needs processing
+// checks if we have Rx frames from the UART that need processing
 void RxService::loop() {
-    while (!rx_telegrams_.empty()) {
-        auto telegram = rx_telegrams_.front().telegram_;
-        (void)EMSESP::process_telegram(telegram); // further process the telegram
-        increment_telegram_count();               // increase rx count
-        rx_telegrams_.pop_front();                // remove it from the queue
+    uint8_t data[EMS_MAXBUFFERSIZE];
+    uint8_t  length;
+    uint32_t time_us;
+    bool     more;
+    while (rx_frames_.pop(data, length, time_us, more)) {
+        Perf::add(Perf::RX_QUEUE, time_us);
+        uint32_t start_us = Perf::now_us();
+        process(data, length, more);
+        Perf::add(Perf::PROCESS, start_us);
+    }
+
+    if (block_first_ && (uuid::get_uptime() - block_time_ > EMS_BLOCK_TIMEOUT)) {
+        flush_block(); // the next part did not come
     }
 }
 
-// add a new rx telegram object
+// count every frame on the bus, also the polls and single byte replies, called from the UART task
+void RxService::add_bus_load(const uint8_t * data, const uint8_t length) {
+    bus_load_.add(::millis(), length, ((data[0] & 0x7F) == ems_bus_id()) || (length > 1 && (data[1] & 0x7F) == ems_bus_id()));
+}
+
+// add a new raw rx frame to the queue, called from the UART task
 // data is the whole telegram, assuming last byte holds the CRC
 // length includes the CRC
-// for EMS+ the type_id has the value + 256. We look for these type of telegrams with F7, F9 and FF in 3rd byte
-void RxService::add(uint8_t * data, uint8_t length) {
+// everything else is done later in process(), from the main loop
+void RxService::add(uint8_t * data, uint8_t length, const bool more) {
     if (length < 5) {
         return;
     }
+    rx_frames_.push(data, length, more);
+}
 
+// validate a raw rx frame, create the telegram object and process it
+// for EMS+ the type_id has the value + 256. We look for these type of telegrams with F7, F9 and FF in 3rd byte
+void RxService::process(uint8_t * data, uint8_t length, const bool more) {
     // validate the CRC. if it fails then increment the number of corrupt/incomplete telegrams and only report to console/syslog
     uint8_t crc = calculate_crc(data, length - 1);
     if (data[length - 1] != crc) {
@@ -157,6 +214,10 @@ void RxService::add(uint8_t * data, uint8_t length) {
         return;
     }
 
+    if (capture_.active()) {
+        capture_.record(data, length - 1); // exclude CRC
+    }
+
     // since it's a valid telegram, work out the ems mask
     // we check the 1st byte, which assumed is the src ID and see if the MSB (8th bit) is set
     // this is used to identify if the protocol should be Junkers/HT3 or Buderus
@@ -219,24 +280,279 @@ void RxService::add(uint8_t * data, uint8_t length) {
         return;
     }
 
-    // create the telegram
-    auto telegram = std::make_shared<Telegram>(operation, src, dest, type_id, offset, message_data, message_length);
+    // create the telegram and process it
+    auto telegram = make_telegram(operation, src, dest, type_id, offset, message_data, message_length);
+    assemble(telegram, more);   // further process the telegram
+    increment_telegram_count(); // increase rx count
+}
+
+// collects the parts of a long telegram we read into one telegram, so the handlers see the whole block at once
+// a reply is held back when TxService::read_next_tx() has queued the read of its next part (more)
+// the block is processed with the last part, when the next part does not follow on or after EMS_BLOCK_TIMEOUT
+void RxService::assemble(std::shared_ptr<const Telegram> telegram, const bool more) {
+    bool reply = (telegram->operation == Telegram::Operation::RX) && (telegram->dest == ems_bus_id());
+
+    if (block_first_ && reply && telegram->src == block_first_->src && telegram->type_id == block_first_->type_id) {
+        if (telegram->offset == block_first_->offset + block_data_.size() && block_data_.size() + telegram->message_length <= EMS_MAX_BLOCK_LENGTH) {
+            block_data_.insert(block_data_.end(), telegram->message_data, telegram->message_data + telegram->message_length);
+            block_time_ = uuid::get_uptime();
+            if (!more) {
+                flush_block();
+            }
+            return;
+        }
+        flush_block(); // a new read of the same telegram
+    }
+
+    if (reply && more) {
+        flush_block();
+        block_first_ = telegram;
+        block_data_.assign(telegram->message_data, telegram->message_data + telegram->message_length);
+        block_time_ = uuid::get_uptime();
+        return;
+    }
+
+    (void)EMSESP::process_telegram(telegram);
+}
 
-    // check if queue is full, if so remove top item to make space
-    if (rx_telegrams_.size() >= MAX_RX_TELEGRAMS) {
-        rx_telegrams_.pop_front();
+// process the collected block
+void RxService::flush_block() {
+    if (!block_first_) {
+        return;
     }
+    auto first = std::move(block_first_);
+    block_first_.reset();
+    EMSESP::read_next(false); // the block is complete, for the response to a read command
+
+    if (block_data_.size() == first->message_length) {
+        (void)EMSESP::process_telegram(first); // only one part
+    } else {
+        blocks_assembled_++;
+        auto block = make_telegram(first->operation, first->src, first->dest, first->type_id, first->offset, block_data_.data(), (uint8_t)block_data_.size());
+        (void)EMSESP::process_telegram(block);
+    }
+    block_data_.clear();
+}
 
-    rx_telegrams_.emplace_back(rx_telegram_id_++, std::move(telegram)); // add to queue
+// allocates the ring and starts recording, a running capture is restarted
+bool RxCapture::start(size_t size) {
+    std::lock_guard<std::mutex> lock{mutex_};
+    buffer_.reset();
+    capacity_ = 0;
+    reset();
+    if (size < HEADER_SIZE + EMS_MAX_TELEGRAM_LENGTH) {
+        return false;
+    }
+    buffer_.reset(new (std::nothrow) uint8_t[size]);
+    if (!buffer_) {
+        return false;
+    }
+    capacity_ = size;
+    return true;
+}
+
+void RxCapture::stop() {
+    std::lock_guard<std::mutex> lock{mutex_};
+    buffer_.reset();
+    capacity_ = 0;
+    reset();
+}
+
+void RxCapture::clear() {
+    std::lock_guard<std::mutex> lock{mutex_};
+    reset();
+}
+
+void RxCapture::reset() {
+    head_    = 0;
+    used_    = 0;
+    frames_  = 0;
+    dropped_ = 0;
+}
+
+size_t RxCapture::tail() const {
+    return head_ >= used_ ? head_ - used_ : head_ + capacity_ - used_;
+}
+
+void RxCapture::put(uint8_t value) {
+    buffer_[head_] = value;
+    if (++head_ == capacity_) {
+        head_ = 0;
+    }
+    used_++;
+}
+
+// drop the oldest frame, the next one becomes the first and gets its time
+void RxCapture::evict() {
+    size_t pos = tail();
+    while (byte_at(pos++) & 0x80) {
+    }
+    size_t length = (pos - tail()) + 1 + byte_at(pos);
+    used_ -= length;
+    frames_--;
+    dropped_++;
+
+    if (frames_) {
+        pos            = tail();
+        uint32_t delta = 0;
+        uint8_t  shift = 0;
+        uint8_t  value;
+        do {
+            value = byte_at(pos++);
+            delta |= (uint32_t)(value & 0x7F) << shift;
+            shift += 7;
+        } while (value & 0x80);
+        first_time_ += delta;
+    }
+}
+
+// called from RxService::process() for each validated frame, without the CRC
+void RxCapture::record(const uint8_t * data, const uint8_t length) {
+    std::lock_guard<std::mutex> lock{mutex_};
+    if (!capacity_) {
+        return; // stopped since the check in process()
+    }
+
+    uint32_t now   = uuid::get_uptime_ms();
+    uint32_t delta = frames_ ? now - last_time_ : 0;
+
+    uint8_t varint = 1;
+    for (uint32_t d = delta >> 7; d; d >>= 7) {
+        varint++;
+    }
+    while (used_ + varint + 1 + length > capacity_ && frames_) {
+        evict();
+    }
+    if (!frames_) {
+        first_time_ = now;
+        delta       = 0;
+    }
+    last_time_ = now;
+
+    do {
+        put((delta & 0x7F) | (delta > 0x7F ? 0x80 : 0));
+        delta >>= 7;
+    } while (delta);
+    put(length);
+    for (uint8_t i = 0; i < length; i++) {
+        put(data[i]);
+    }
+    frames_++;
+}
+
+// the header and the frames, oldest first
+std::vector<uint8_t> RxCapture::snapshot() const {
+    std::lock_guard<std::mutex> lock{mutex_};
+    std::vector<uint8_t>        out;
+    out.reserve(HEADER_SIZE + used_);
+    out.insert(out.end(), {'E', 'M', 'S', 'C', VERSION, 0});
+    for (uint32_t value : {first_time_, dropped_}) {
+        for (uint8_t i = 0; i < 4; i++) {
+            out.push_back((value >> (i * 8)) & 0xFF);
+        }
+    }
+    size_t pos = tail();
+    for (size_t i = 0; i < used_; i++) {
+        out.push_back(byte_at(pos + i));
+    }
+    return out;
 }
 
-// add empty telegram to rx-queue
+bool RxCapture::decode(const uint8_t * data, size_t length, const FrameCallback & callback) {
+    if (length < HEADER_SIZE || memcmp(data, "EMSC", 4) || data[4] != VERSION) {
+        return false;
+    }
+    uint32_t time = data[6] | (data[7] << 8) | (data[8] << 16) | ((uint32_t)data[9] << 24);
+
+    size_t pos   = HEADER_SIZE;
+    bool   first = true;
+    while (pos < length) {
+        uint32_t delta = 0;
+        uint8_t  shift = 0;
+        while (pos < length && (data[pos] & 0x80) && shift < 28) {
+            delta |= (uint32_t)(data[pos++] & 0x7F) << shift;
+            shift += 7;
+        }
+        if (pos + 2 > length) {
+            return false; // truncated
+        }
+        delta |= (uint32_t)data[pos++] << shift;
+        uint8_t frame_length = data[pos++];
+        if (pos + frame_length > length) {
+            return false;
+        }
+        // the delta of the first frame points to a frame that was dropped, the header has its time
+        if (!first) {
+            time += delta;
+        }
+        first = false;
+        callback(time, data + pos, frame_length);
+        pos += frame_length;
+    }
+    return true;
+}
+
+void BusLoad::add(const uint32_t now_ms, const uint8_t length, const bool own) {
+    uint32_t sec  = now_ms / 1000;
+    uint8_t  slot = sec % BUS_LOAD_WINDOW;
+    if (slot_sec_[slot] != sec) {
+        slot_sec_[slot] = sec;
+        busy_us_[slot]  = 0;
+        own_us_[slot]   = 0;
+    }
+    busy_us_[slot] += frame_us(length);
+    if (own) {
+        own_us_[slot] += frame_us(length);
+    }
+}
+
+uint8_t BusLoad::percent(const uint32_t now_ms, const uint32_t * slots_us) const {
+    uint32_t sec   = now_ms / 1000;
+    uint64_t total = 0;
+    for (uint8_t i = 0; i < BUS_LOAD_WINDOW; i++) {
+        if (sec - slot_sec_[i] < BUS_LOAD_WINDOW) {
+            total += slots_us[i];
+        }
+    }
+    // the current slot is still filling, so count it as a part of the window
+    uint32_t window_ms = (BUS_LOAD_WINDOW - 1) * 1000 + now_ms % 1000;
+    uint32_t p         = window_ms ? total / 10 / window_ms : 0;
+    return p > 100 ? 100 : p;
+}
+
+bool TxPacer::allow(const uint32_t now_ms, const uint32_t cost_us, const uint8_t busy) {
+    if (share_ >= 100) {
+        return true;
+    }
+    uint32_t free   = busy < 100 ? 100 - busy : 0;
+    uint64_t tokens = tokens_us_ + (uint64_t)(now_ms - last_ms_) * share_ * free / 10;
+    last_ms_        = now_ms;
+    tokens_us_      = tokens > BURST_US ? BURST_US : tokens;
+    if (tokens_us_ < cost_us) {
+        deferred_++;
+        return false;
+    }
+    tokens_us_ -= cost_us;
+    return true;
+}
+
+// add empty telegram to rx-queue, as a raw frame with only the header and CRC
 void RxService::add_empty(const uint8_t src, const uint8_t dest, const uint16_t type_id, uint8_t offset) {
-    auto telegram = std::make_shared<Telegram>(Telegram::Operation::RX, src, dest, type_id, offset, nullptr, 0);
-    // only if queue is  not full
-    if (rx_telegrams_.size() < MAX_RX_TELEGRAMS) {
-        rx_telegrams_.emplace_back(rx_telegram_id_++, std::move(telegram)); // add to queue
+    uint8_t data[7];
+    uint8_t length = 0;
+    data[length++] = src;
+    data[length++] = dest;
+    if (type_id > 0xFF) {
+        data[length++] = 0xFF;
+        data[length++] = offset;
+        data[length++] = (type_id >> 8) - 1;
+        data[length++] = type_id & 0xFF;
+    } else {
+        data[length++] = type_id;
+        data[length++] = offset;
     }
+    data[length] = calculate_crc(data, length);
+    rx_frames_.push(data, length + 1); // only if queue is not full
 }
 
 // start and initialize Tx
@@ -296,6 +612,14 @@ void TxService::send() {
     }
     delayed_send_ = 0;
 
+    // stay within our share of the bus time, the telegram is sent on a later poll
+    uint32_t now  = ::millis();
+    auto &   load = EMSESP::rxservice_.bus_load();
+    if (!pacer_.allow(now, bus_time(*tx_telegrams_.front().telegram_), load.utilization(now) - load.own_utilization(now))) {
+        send_poll();
+        return;
+    }
+
     // if we're in read-only mode (tx_mode 0) forget the Tx call
     if (tx_mode() != 0) {
         send_telegram(tx_telegrams_.front());
@@ -304,6 +628,16 @@ void TxService::send() {
     tx_telegrams_.pop_front(); // remove the telegram from the queue
 }
 
+// estimated bus time of a Tx telegram and its answer, a reply with the data asked for or a one byte ack
+uint32_t TxService::bus_time(const Telegram & telegram) {
+    uint8_t header = telegram.type_id > 0xFF ? 6 : 4;
+    if (telegram.operation == Telegram::Operation::TX_READ) {
+        uint8_t request = telegram.type_id > 0xFF ? 8 : 6;
+        return BusLoad::frame_us(request) + BusLoad::frame_us(header + telegram.message_data[0] + 1);
+    }
+    return BusLoad::frame_us(header + telegram.message_length + 1) + BusLoad::frame_us(1);
+}
+
 // process a Tx telegram
 void TxService::send_telegram(const QueuedTxTelegram & tx_telegram) {
     static uint8_t telegram_raw[EMS_MAX_TELEGRAM_LENGTH];
@@ -367,7 +701,7 @@ void TxService::send_telegram(const QueuedTxTelegram & tx_telegram) {
         }
     }
     // make a copy of the telegram with new dest (without read-flag)
-    telegram_last_ = std::make_shared<Telegram>(
+    telegram_last_ = make_telegram(
         telegram->operation, telegram->src, dest & 0x7F, telegram->type_id, telegram->offset, telegram->message_data, telegram->message_length);
 
     uint8_t length       = message_p;
@@ -439,29 +773,11 @@ void TxService::add(const uint8_t  operation,
                     const uint8_t  message_length,
                     const uint16_t validateid,
                     const bool     front) {
-    auto telegram = std::make_shared<Telegram>(operation, ems_bus_id(), dest, type_id, offset, message_data, message_length);
+    auto telegram = make_telegram(operation, ems_bus_id(), dest, type_id, offset, message_data, message_length);
 
     LOG_DEBUG("New Tx [#%d] telegram, length %d", tx_telegram_id_, message_length);
 
-    // if the queue is full, make room by removing the last one
-    if (tx_telegrams_.size() >= MAX_TX_TELEGRAMS) {
-        LOG_WARNING("Tx queue overflow, skip one message");
-        if (tx_telegrams_.front().telegram_->operation == Telegram::Operation::TX_WRITE) {
-            telegram_write_fail_count_++;
-        } else {
-            telegram_read_fail_count_++;
-        }
-        tx_telegrams_.pop_front();
-    }
-
-    if (front) {
-        tx_telegrams_.emplace_front(tx_telegram_id_++, std::move(telegram), false, validateid); // add to front of queue
-    } else {
-        tx_telegrams_.emplace_back(tx_telegram_id_++, std::move(telegram), false, validateid); // add to back of queue
-    }
-    if (validateid != 0) {
-        EMSESP::wait_validate(validateid);
-    }
+    enqueue(std::move(telegram), validateid, front);
 }
 
 // builds a Tx telegram and adds to queue
@@ -525,31 +841,86 @@ void TxService::add(uint8_t operation, const uint8_t * data, const uint8_t lengt
         }
     }
 
-    auto telegram = std::make_shared<Telegram>(operation, src, dest, type_id, offset, message_data, message_length); // operation is TX_WRITE or TX_READ
+    auto telegram = make_telegram(operation, src, dest, type_id, offset, message_data, message_length); // operation is TX_WRITE or TX_READ
+
+    LOG_DEBUG("New Tx [#%d] telegram, length %d", tx_telegram_id_, message_length);
+
+    enqueue(std::move(telegram), validate_id, front);
+}
+
+// returns true if both telegrams ask for the same data, or write to the same place
+static bool same_request(const Telegram & a, const Telegram & b) {
+    if (a.operation != b.operation || a.src != b.src || a.dest != b.dest || a.type_id != b.type_id || a.offset != b.offset) {
+        return false;
+    }
+    if (a.operation == Telegram::Operation::TX_READ) {
+        return a.message_data[0] == b.message_data[0]; // the number of bytes to read
+    }
+    return a.message_length == b.message_length;
+}
+
+// add a telegram to the Tx queue, at the front or at the end of its priority class
+// a read that is already queued is not added again and a queued write to the same place is replaced
+// if the queue is full the newest telegram of the lowest class is dropped
+void TxService::enqueue(std::shared_ptr<Telegram> && telegram, const uint16_t validateid, const bool front) {
+    const bool    is_read  = telegram->operation == Telegram::Operation::TX_READ;
+    const uint8_t priority = (front || !is_read) ? (uint8_t)PRIORITY_HIGH : read_priority_;
+
+    if (is_read || telegram->operation == Telegram::Operation::TX_WRITE) {
+        for (auto it = tx_telegrams_.begin(); it != tx_telegrams_.end(); ++it) {
+            if (it->retry_ || !same_request(*it->telegram_, *telegram)) {
+                continue;
+            }
+            if (is_read) {
+                reads_coalesced_++;
+                if (!front && it->priority_ <= priority) {
+                    LOG_DEBUG("Tx read already queued as [#%d]", it->id_);
+                    return;
+                }
+            } else {
+                writes_superseded_++;
+                LOG_DEBUG("Tx write [#%d] superseded", it->id_);
+            }
+            tx_telegrams_.erase(it); // re-added below with the new data or the higher class
+            break;
+        }
+    }
 
-    // if the queue is full, make room by removing the last one
     if (tx_telegrams_.size() >= MAX_TX_TELEGRAMS) {
         LOG_WARNING("Tx queue overflow, skip one message");
-        if (tx_telegrams_.front().telegram_->operation == Telegram::Operation::TX_WRITE) {
+        bool drop_new = !front && tx_telegrams_.back().priority_ < priority;
+        if ((drop_new ? telegram->operation : tx_telegrams_.back().telegram_->operation) == Telegram::Operation::TX_WRITE) {
             telegram_write_fail_count_++;
         } else {
             telegram_read_fail_count_++;
         }
-        tx_telegrams_.pop_front();
+        if (drop_new) {
+            return;
+        }
+        tx_telegrams_.pop_back();
     }
 
-    LOG_DEBUG("New Tx [#%d] telegram, length %d", tx_telegram_id_, message_length);
-
     if (front) {
-        // tx_telegrams_.push_front(qtxt); // add to front of queue
-        tx_telegrams_.emplace_front(tx_telegram_id_++, std::move(telegram), false, validate_id); // add to front of queue
+        tx_telegrams_.emplace_front(tx_telegram_id_++, std::move(telegram), false, validateid, priority); // add to front of queue
     } else {
-        // tx_telegrams_.push_back(qtxt); // add to back of queue
-        tx_telegrams_.emplace_back(tx_telegram_id_++, std::move(telegram), false, validate_id); // add to back of queue
+        auto pos = tx_telegrams_.end();
+        while (pos != tx_telegrams_.begin() && std::prev(pos)->priority_ > priority) {
+            --pos;
+        }
+        tx_telegrams_.emplace(pos, tx_telegram_id_++, std::move(telegram), false, validateid, priority); // add to the end of its class
     }
-    if (validate_id != 0) {
-        EMSESP::wait_validate(validate_id);
+    if (validateid != 0) {
+        EMSESP::wait_validate(validateid);
+    }
+}
+
+// number of queued telegrams of a priority class
+uint8_t TxService::queue_size(const uint8_t priority) const {
+    uint8_t count = 0;
+    for (const auto & tx_telegram : tx_telegrams_) {
+        count += (tx_telegram.priority_ == priority);
     }
+    return count;
 }
 
 // send a Tx telegram to request data from an EMS device
@@ -631,7 +1002,7 @@ void TxService::retry_tx(const uint8_t operation, const uint8_t * data, const ui
         tx_telegrams_.pop_back();
     }
 
-    tx_telegrams_.emplace_front(tx_telegram_id_++, std::move(telegram_last_), true, get_post_send_query());
+    tx_telegrams_.emplace_front(tx_telegram_id_++, std::move(telegram_last_), true, get_post_send_query(), PRIORITY_HIGH);
 }
 
 // send a request to read the next block of data from longer telegrams
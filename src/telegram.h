@@ -21,6 +21,11 @@
 
 #include <string>
 #include <deque>
+#include <atomic>
+#include <memory>
+#include <mutex>
+#include <vector>
+#include <functional>
 #include <uuid/log.h>
 
 // UART drivers
@@ -31,8 +36,9 @@
 #endif
 
 #include "helpers.h"
+#include "perf.h"
 
-#define MAX_RX_TELEGRAMS 10  // size of Rx queue
+#define MAX_RX_TELEGRAMS 32  // size of Rx queue, must be a power of 2
 #define MAX_TX_TELEGRAMS 100 // size of Tx queue
 
 // default values for null values
@@ -49,6 +55,7 @@ static constexpr uint32_t EMS_VALUE_ULLONG_NOTSET = 0xFFFFFFFF; // for 4-byte lo
 
 static constexpr uint8_t EMS_MAX_TELEGRAM_LENGTH         = 32; // max length of a complete EMS telegram
 static constexpr uint8_t EMS_MAX_TELEGRAM_MESSAGE_LENGTH = 27; // max length of message block, assuming EMS1.0
+static constexpr uint8_t EMS_MAX_BLOCK_LENGTH            = 255; // max length of the message block of a long telegram read in parts
 
 #define EMS_VALUE_DEFAULT_INT EMS_VALUE_INT_NOTSET
 #define EMS_VALUE_DEFAULT_UINT EMS_VALUE_UINT_NOTSET
@@ -80,13 +87,16 @@ class Telegram {
              const uint8_t   message_length);
     ~Telegram() = default;
 
+    Telegram(const Telegram &)             = delete;
+    Telegram & operator=(const Telegram &) = delete;
+
     const uint8_t  operation; // is Operation mode
     const uint8_t  src;       // device_id
     const uint8_t  dest;      // device_id
     const uint16_t type_id;
     const uint8_t  offset;
     const uint8_t  message_length;
-    uint8_t        message_data[EMS_MAX_TELEGRAM_MESSAGE_LENGTH];
+    uint8_t * const message_data; // in the telegram itself, or on the heap for a block longer than one frame
 
     enum Operation : uint8_t {
         NONE = 0,
@@ -103,7 +113,7 @@ class Telegram {
     // reads a bit value from a given telegram position
     bool read_bitvalue(uint8_t & value, const uint8_t index, const uint8_t bit) const {
         uint8_t abs_index = (index - this->offset);
-        if ((abs_index >= this->message_length) || (abs_index > EMS_MAX_TELEGRAM_MESSAGE_LENGTH)) {
+        if (abs_index >= this->message_length) {
             return false; // out of bounds
         }
 
@@ -138,7 +148,7 @@ class Telegram {
 // Serial.println();
 #endif
 
-        if ((index < this->offset) || (msg_size >= this->message_length) || (msg_size > EMS_MAX_TELEGRAM_MESSAGE_LENGTH)) {
+        if ((index < this->offset) || (msg_size >= this->message_length)) {
             return false;
         }
 
@@ -163,8 +173,74 @@ class Telegram {
 
   private:
     int8_t _getDataPosition(const uint8_t index, const uint8_t size) const;
+
+    uint8_t                    data_[EMS_MAX_TELEGRAM_MESSAGE_LENGTH];
+    std::unique_ptr<uint8_t[]> block_; // only for a block longer than one frame
+};
+
+// fixed size pool for Telegram objects, to avoid lots of small heap allocations on a busy bus
+// each block holds a Telegram together with its std::shared_ptr control block, see make_telegram()
+// when the pool is exhausted it falls back to the heap
+class TelegramPool {
+  public:
+    static constexpr uint8_t POOL_SIZE  = 64; // max # telegrams in the pool, one bit each in used_
+    static constexpr size_t  BLOCK_SIZE = (sizeof(Telegram) + 4 * sizeof(void *) + 7) & ~(size_t)7;
+
+    static void * allocate(const size_t size);
+    static void   deallocate(void * p);
+
+    static uint8_t used();
+    static uint8_t max_used() {
+        return max_used_;
+    }
+    static uint32_t heap_fallbacks() {
+        return heap_fallbacks_;
+    }
+
+  private:
+    alignas(8) static uint8_t blocks_[POOL_SIZE][BLOCK_SIZE];
+    static uint64_t   used_; // bitmask of blocks in use
+    static uint8_t    max_used_;
+    static uint32_t   heap_fallbacks_;
+    static std::mutex mutex_; // telegrams are created in both the UART task and the main loop
+};
+
+// allocator for std::allocate_shared, using the TelegramPool
+template <typename T>
+class TelegramAllocator {
+  public:
+    using value_type = T;
+
+    TelegramAllocator() = default;
+    template <typename U>
+    TelegramAllocator(const TelegramAllocator<U> &) {
+    }
+
+    T * allocate(const size_t n) {
+        static_assert(sizeof(T) <= TelegramPool::BLOCK_SIZE, "telegram pool block size too small");
+        return static_cast<T *>(TelegramPool::allocate(n * sizeof(T)));
+    }
+
+    void deallocate(T * p, const size_t n) {
+        TelegramPool::deallocate(p);
+    }
+
+    template <typename U>
+    bool operator==(const TelegramAllocator<U> &) const {
+        return true;
+    }
+    template <typename U>
+    bool operator!=(const TelegramAllocator<U> &) const {
+        return false;
+    }
 };
 
+// creates a pooled telegram, a drop-in for std::make_shared<Telegram>()
+template <typename... Args>
+std::shared_ptr<Telegram> make_telegram(Args &&... args) {
+    return std::allocate_shared<Telegram>(TelegramAllocator<Telegram>(), std::forward<Args>(args)...);
+}
+
 class EMSbus {
   public:
     static uuid::log::Logger logger_;
@@ -255,13 +331,215 @@ class EMSbus {
     static uint8_t  tx_state_;          // state of the Tx line (NONE or waiting on a TX_READ or TX_WRITE)
 };
 
+// fixed size lock-free ring buffer of raw Rx frames (including the CRC)
+// single producer (the UART task via EMSESP::incoming_telegram) and single consumer (RxService::loop)
+// the producer only writes head_ and the consumer only writes tail_, so no locking is needed
+// when the ring is full new frames are dropped and counted as an overrun
+class RxFrameQueue {
+  public:
+    static constexpr uint8_t QUEUE_SIZE = MAX_RX_TELEGRAMS;
+    static_assert((QUEUE_SIZE & (QUEUE_SIZE - 1)) == 0 && QUEUE_SIZE <= 128, "queue size must be a power of 2, max 128");
+
+    // called by the producer only
+    bool push(const uint8_t * data, const uint8_t length, const bool more = false) {
+        if (length > EMS_MAXBUFFERSIZE) {
+            return false;
+        }
+        uint8_t head  = head_.load(std::memory_order_relaxed);
+        uint8_t count = (uint8_t)(head - tail_.load(std::memory_order_acquire));
+        if (count >= QUEUE_SIZE) {
+            overruns_.fetch_add(1, std::memory_order_relaxed);
+            return false;
+        }
+        Frame & frame = frames_[head & (QUEUE_SIZE - 1)];
+        memcpy(frame.data, data, length);
+        frame.length  = length;
+        frame.more    = more;
+        frame.time_us = Perf::now_us();
+        head_.store((uint8_t)(head + 1), std::memory_order_release);
+        if (++count > high_water_.load(std::memory_order_relaxed)) {
+            high_water_.store(count, std::memory_order_relaxed);
+        }
+        return true;
+    }
+
+    // called by the consumer only. Copies the oldest frame into data, which must hold EMS_MAXBUFFERSIZE bytes
+    // time_us is set to when the frame was pushed, more if the next part of the telegram was requested
+    bool pop(uint8_t * data, uint8_t & length, uint32_t & time_us, bool & more) {
+        uint8_t tail = tail_.load(std::memory_order_relaxed);
+        if (tail == head_.load(std::memory_order_acquire)) {
+            return false; // empty
+        }
+        const Frame & frame = frames_[tail & (QUEUE_SIZE - 1)];
+        length              = frame.length;
+        time_us             = frame.time_us;
+        more                = frame.more;
+        memcpy(data, frame.data, length);
+        tail_.store((uint8_t)(tail + 1), std::memory_order_release);
+        return true;
+    }
+
+    uint8_t size() const {
+        return (uint8_t)(head_.load(std::memory_order_acquire) - tail_.load(std::memory_order_acquire));
+    }
+
+    bool empty() const {
+        return size() == 0;
+    }
+
+    uint32_t overruns() const {
+        return overruns_.load(std::memory_order_relaxed);
+    }
+
+    uint8_t high_water() const {
+        return high_water_.load(std::memory_order_relaxed);
+    }
+
+  private:
+    struct Frame {
+        uint32_t time_us;
+        uint8_t  length;
+        bool     more;
+        uint8_t  data[EMS_MAXBUFFERSIZE];
+    };
+
+    Frame                 frames_[QUEUE_SIZE];
+    std::atomic<uint8_t>  head_{0};       // next slot to write, producer owned
+    std::atomic<uint8_t>  tail_{0};       // next slot to read, consumer owned
+    std::atomic<uint32_t> overruns_{0};   // # frames dropped because the queue was full
+    std::atomic<uint8_t>  high_water_{0}; // max # frames waiting in the queue
+};
+
+// compact binary recording of the validated Rx frames, kept in a fixed size ring in RAM
+// a snapshot starts with a header: "EMSC", version, reserved byte, uptime (ms) of the first frame and
+// the number of frames dropped from the ring, both uint32 little endian
+// followed by each frame as: ms since the previous frame (LEB128 varint), length, frame without the CRC
+// when the ring is full the oldest frames are dropped
+class RxCapture {
+  public:
+    static constexpr uint8_t VERSION     = 1;
+    static constexpr uint8_t HEADER_SIZE = 14;
+
+    using FrameCallback = std::function<void(uint32_t uptime_ms, const uint8_t * data, uint8_t length)>;
+
+    bool start(size_t size);
+    void stop();
+    void clear();
+    void record(const uint8_t * data, const uint8_t length);
+
+    bool active() const {
+        return capacity_ != 0;
+    }
+
+    size_t capacity() const {
+        return capacity_;
+    }
+
+    size_t used() const {
+        return used_;
+    }
+
+    uint32_t frames() const {
+        return frames_;
+    }
+
+    uint32_t dropped() const {
+        return dropped_;
+    }
+
+    std::vector<uint8_t> snapshot() const;
+
+    // decodes a snapshot, calls the callback for each frame. Returns false if it's not a valid capture
+    static bool decode(const uint8_t * data, size_t length, const FrameCallback & callback);
+
+  private:
+    uint8_t byte_at(size_t pos) const {
+        return buffer_[pos < capacity_ ? pos : pos - capacity_];
+    }
+    void   put(uint8_t value);
+    size_t tail() const;
+    void   evict();
+    void   reset();
+
+    mutable std::mutex         mutex_; // recorded in the main loop, controlled and read by commands and the web server
+    std::unique_ptr<uint8_t[]> buffer_;
+    size_t                     capacity_   = 0; // 0 when not capturing
+    size_t                     head_       = 0; // next byte to write
+    size_t                     used_       = 0; // bytes in use
+    uint32_t                   frames_     = 0; // frames in the ring
+    uint32_t                   dropped_    = 0; // frames dropped to make room
+    uint32_t                   first_time_ = 0; // uptime of the oldest frame
+    uint32_t                   last_time_  = 0; // uptime of the newest frame
+};
+
+// estimate of the share of bus time in use, from the frames seen on the bus
+// a byte takes 10 bits at 9600 baud and each frame ends with a break of about one byte
+// the time is counted in one second slots over the last BUS_LOAD_WINDOW seconds
+// written from the UART task only, reading it from the main loop gives a slightly stale value
+class BusLoad {
+  public:
+    static constexpr uint32_t BYTE_US         = 1042;
+    static constexpr uint8_t  BUS_LOAD_WINDOW = 10;
+
+    static uint32_t frame_us(const uint8_t length) {
+        return (length + 1) * BYTE_US;
+    }
+
+    // own is true for the echo of our own Tx and the replies sent to us
+    void add(const uint32_t now_ms, const uint8_t length, const bool own);
+
+    // in %
+    uint8_t utilization(const uint32_t now_ms) const {
+        return percent(now_ms, busy_us_);
+    }
+    uint8_t own_utilization(const uint32_t now_ms) const {
+        return percent(now_ms, own_us_);
+    }
+
+  private:
+    uint8_t percent(const uint32_t now_ms, const uint32_t * slots_us) const;
+
+    uint32_t slot_sec_[BUS_LOAD_WINDOW]{}; // second of each slot
+    uint32_t busy_us_[BUS_LOAD_WINDOW]{};
+    uint32_t own_us_[BUS_LOAD_WINDOW]{};
+};
+
+// token bucket of bus time for our own Tx, refilled at share % of the bus time the others leave free
+// a share of 100 does not limit the Tx
+class TxPacer {
+  public:
+    static constexpr uint32_t BURST_US = 250000; // most bus time that can be saved up
+
+    void share(const uint8_t percent) {
+        share_ = percent > 100 ? 100 : percent;
+    }
+    uint8_t share() const {
+        return share_;
+    }
+
+    // takes cost_us from the bucket, returns false if there is not enough bus time left
+    // busy is the % of bus time used by the other devices, see BusLoad
+    bool allow(const uint32_t now_ms, const uint32_t cost_us, const uint8_t busy);
+
+    uint32_t deferred() const {
+        return deferred_;
+    }
+
+  private:
+    uint8_t  share_     = 100;
+    uint32_t tokens_us_ = BURST_US;
+    uint32_t last_ms_   = 0;
+    uint32_t deferred_  = 0; // # polls we let pass to stay within the share
+};
+
 class RxService : public EMSbus {
   public:
     RxService()  = default;
     ~RxService() = default;
 
     void loop();
-    void add(uint8_t * data, uint8_t length);
+    void add(uint8_t * data, uint8_t length, const bool more = false);
+    void add_bus_load(const uint8_t * data, const uint8_t length);
     void add_empty(const uint8_t src, const uint8_t dst, const uint16_t type_id, uint8_t offset);
 
     uint32_t telegram_count() const {
@@ -285,30 +563,49 @@ class RxService : public EMSbus {
         return (q <= EMS_BUS_QUALITY_RX_THRESHOLD ? 100 : 100 - q);
     }
 
-    struct QueuedRxTelegram {
-      public:
-        const uint16_t                        id_;
-        const std::shared_ptr<const Telegram> telegram_;
+    uint8_t queue_size() const {
+        return rx_frames_.size();
+    }
 
-        ~QueuedRxTelegram() = default;
-        QueuedRxTelegram(uint16_t id, std::shared_ptr<Telegram> && telegram)
-            : id_(id)
-            , telegram_(std::move(telegram)) {
-        }
-    };
+    uint32_t queue_overruns() const {
+        return rx_frames_.overruns();
+    }
 
-    std::deque<QueuedRxTelegram> queue() const {
-        return rx_telegrams_;
+    uint8_t queue_high_water() const {
+        return rx_frames_.high_water();
     }
 
-  private:
-    static constexpr uint8_t EMS_BUS_QUALITY_RX_THRESHOLD = 5; // % threshold before reporting quality issues
+    RxCapture & capture() {
+        return capture_;
+    }
+
+    const BusLoad & bus_load() const {
+        return bus_load_;
+    }
+
+    uint32_t blocks_assembled() const {
+        return blocks_assembled_;
+    }
 
-    uint8_t                         rx_telegram_id_       = 0; // queue counter
-    uint32_t                        telegram_count_       = 0; // # Rx received
-    uint32_t                        telegram_error_count_ = 0; // # Rx CRC errors
-    std::shared_ptr<const Telegram> rx_telegram;               // the incoming Rx telegram
-    std::deque<QueuedRxTelegram>    rx_telegrams_;             // the Rx Queue
+  private:
+    static constexpr uint8_t  EMS_BUS_QUALITY_RX_THRESHOLD = 5;    // % threshold before reporting quality issues
+    static constexpr uint32_t EMS_BLOCK_TIMEOUT            = 2000; // ms to wait for the next part of a long telegram
+
+    void process(uint8_t * data, uint8_t length, const bool more);
+    void assemble(std::shared_ptr<const Telegram> telegram, const bool more);
+    void flush_block();
+
+    uint32_t     telegram_count_       = 0; // # Rx received
+    uint32_t     telegram_error_count_ = 0; // # Rx CRC errors
+    RxFrameQueue rx_frames_;                // the Rx Queue, raw frames from the UART
+    RxCapture    capture_;                  // recording of the validated frames
+    BusLoad      bus_load_;                 // utilization of the bus
+
+    // a long telegram we read in parts, collected into one block
+    std::shared_ptr<const Telegram> block_first_; // the first part, empty if no block is being collected
+    std::vector<uint8_t>            block_data_;
+    uint32_t                        block_time_       = 0; // uptime of the last part
+    uint32_t                        blocks_assembled_ = 0; // # blocks of more than one part
 };
 
 class TxService : public EMSbus {
@@ -413,18 +710,28 @@ class TxService : public EMSbus {
         telegram_write_fail_count_++;
     }
 
+    // priority classes of the Tx queue. The queue is kept sorted by class, and in order of arrival within a class
+    enum Priority : uint8_t {
+        PRIORITY_HIGH,  // writes, raw telegrams, retries and reads added to the front like the post-send validation
+        PRIORITY_USER,  // reads from commands, the console and devices
+        PRIORITY_FETCH, // the periodic fetch of all values
+        PRIORITIES
+    };
+
     struct QueuedTxTelegram {
-        const uint16_t                        id_;
-        const std::shared_ptr<const Telegram> telegram_;
-        const bool                            retry_; // true if its a retry
-        const uint16_t                        validateid_;
+        uint16_t                        id_;
+        std::shared_ptr<const Telegram> telegram_;
+        bool                            retry_; // true if its a retry
+        uint16_t                        validateid_;
+        uint8_t                         priority_;
 
         ~QueuedTxTelegram() = default;
-        QueuedTxTelegram(uint16_t id, std::shared_ptr<Telegram> && telegram, bool retry, uint16_t validateid)
+        QueuedTxTelegram(uint16_t id, std::shared_ptr<Telegram> && telegram, bool retry, uint16_t validateid, uint8_t priority)
             : id_(id)
             , telegram_(std::move(telegram))
             , retry_(retry)
-            , validateid_(validateid) {
+            , validateid_(validateid)
+            , priority_(priority) {
         }
     };
 
@@ -436,6 +743,27 @@ class TxService : public EMSbus {
         return tx_telegrams_.empty();
     }
 
+    uint8_t queue_size(const uint8_t priority) const;
+
+    // the class of new reads that are not added to the front, PRIORITY_USER unless a fetch is running
+    void read_priority(const uint8_t priority) {
+        read_priority_ = priority;
+    }
+
+    uint32_t reads_coalesced() const {
+        return reads_coalesced_;
+    }
+
+    uint32_t writes_superseded() const {
+        return writes_superseded_;
+    }
+
+    TxPacer & pacer() {
+        return pacer_;
+    }
+
+    static uint32_t bus_time(const Telegram & telegram);
+
 #if defined(EMSESP_DEBUG)
     static constexpr uint8_t MAXIMUM_TX_RETRIES = 0; // when compiled with EMSESP_DEBUG don't retry
 #else
@@ -459,7 +787,13 @@ class TxService : public EMSbus {
 
     uint8_t tx_telegram_id_ = 0; // queue counter
 
+    uint8_t  read_priority_     = PRIORITY_USER;
+    uint32_t reads_coalesced_   = 0; // # reads skipped or merged because the same read was already queued
+    uint32_t writes_superseded_ = 0; // # queued writes replaced by a newer write of the same data
+    TxPacer  pacer_;
+
     void send_telegram(const QueuedTxTelegram & tx_telegram);
+    void enqueue(std::shared_ptr<Telegram> && telegram, const uint16_t validateid, const bool front);
 };
 
 } // namespace emsesp
@@ -105,11 +105,19 @@ void TemperatureSensor::loop() {
         }
     } else if (state_ == State::READING) {
         if (temperature_convert_complete() && (time_now - last_activity_ > CONVERSION_MS)) {
+            // search the bus at startup, on a failure or every RESCAN_MS, else read the known sensors by their ROM code
+            if (rescan_ || scancnt_ <= 0 || sensors_.empty() || (time_now - last_scan_ >= RESCAN_MS)) {
 #ifdef EMSESP_DEBUG_SENSOR
-            LOG_DEBUG("Scanning for temperature sensors");
+                LOG_DEBUG("Scanning for temperature sensors");
 #endif
-            bus_.reset_search();
-            state_ = State::SCANNING;
+                bus_.reset_search();
+                state_     = State::SCANNING;
+                last_scan_ = time_now;
+                rescan_    = false;
+            } else {
+                state_ = State::FETCHING;
+                fetch_ = 0;
+            }
         } else if (time_now - last_activity_ > READ_TIMEOUT_MS) {
 #ifdef EMSESP_DEBUG_SENSOR
             LOG_WARNING("Sensor read timeout");
@@ -145,14 +153,8 @@ void TemperatureSensor::loop() {
                             bool found = false;
                             for (auto & sensor : sensors_) {
                                 if (sensor.internal_id() == get_id(addr)) {
-                                    t += sensor.offset();
-                                    if (t != sensor.temperature_c) {
-                                        sensor.temperature_c = t;
-                                        publish_sensor(sensor);
-                                        changed_ |= true;
-                                    }
-                                    sensor.read = true;
-                                    found       = true;
+                                    set_temperature(sensor, t);
+                                    found = true;
                                     break;
                                 }
                             }
@@ -207,10 +209,39 @@ void TemperatureSensor::loop() {
                 state_ = State::IDLE;
             }
         }
+    } else if (state_ == State::FETCHING) {
+        // one known sensor per loop, as in the scan
+        if (fetch_ < sensors_.size()) {
+            auto &  sensor = sensors_[fetch_++];
+            int16_t t      = get_temperature_c(sensor.rom());
+            if ((t >= -550) && (t <= 1250)) {
+                sensorreads_++;
+                set_temperature(sensor, t);
+            } else {
+                sensorfails_++;
+                rescan_ = true; // missing or disturbed, find out with the next scan
+            }
+        } else {
+            if (!parasite_) {
+                bus_.depower();
+            }
+            state_ = State::IDLE;
+        }
     }
 #endif
 }
 
+// apply the offset and publish the temperature if it changed
+void TemperatureSensor::set_temperature(Sensor & sensor, int16_t t) {
+    t += sensor.offset();
+    if (t != sensor.temperature_c) {
+        sensor.temperature_c = t;
+        publish_sensor(sensor);
+        changed_ |= true;
+    }
+    sensor.read = true;
+}
+
 bool TemperatureSensor::temperature_convert_complete() {
 #ifndef EMSESP_STANDALONE
     if (parasite_) {
@@ -235,12 +266,7 @@ int16_t TemperatureSensor::get_temperature_c(const uint8_t addr[]) {
     bus_.write(CMD_READ_SCRATCHPAD);
     bus_.read_bytes(scratchpad, SCRATCHPAD_LEN);
     YIELD;
-
-    if (!bus_.reset()) {
-        LOG_ERROR("Bus reset failed after reading scratchpad from %s", Sensor(addr).id().c_str());
-        return EMS_VALUE_SHORT_NOTSET;
-    }
-    YIELD;
+    // no reset after the read, the next command starts with one and the CRC checks the data
 
     if (bus_.crc8(scratchpad, SCRATCHPAD_LEN - 1) != scratchpad[SCRATCHPAD_LEN - 1]) {
         LOG_WARNING("Invalid scratchpad CRC: %02X%02X%02X%02X%02X%02X%02X%02X%02X from sensor %s",
@@ -572,6 +598,8 @@ void TemperatureSensor::publish_values(const bool force) {
 TemperatureSensor::Sensor::Sensor(const uint8_t addr[])
     : internal_id_(((uint64_t)addr[0] << 48) | ((uint64_t)addr[1] << 40) | ((uint64_t)addr[2] << 32) | ((uint64_t)addr[3] << 24) | ((uint64_t)addr[4] << 16)
                    | ((uint64_t)addr[5] << 8) | ((uint64_t)addr[6])) {
+    memcpy(rom_, addr, sizeof(rom_));
+
     // create ID string
     char id_s[20];
     snprintf(id_s,
@@ -44,6 +44,10 @@ class TemperatureSensor {
             return internal_id_;
         }
 
+        const uint8_t * rom() const {
+            return rom_;
+        }
+
         std::string id() const {
             return id_;
         }
@@ -69,6 +73,7 @@ class TemperatureSensor {
 
       private:
         uint64_t    internal_id_;
+        uint8_t     rom_[8]; // 1-wire ROM code, for reading the sensor directly
         std::string id_;
         std::string name_;
         int16_t     offset_;
@@ -119,7 +124,7 @@ class TemperatureSensor {
   private:
     static constexpr uint8_t MAX_SENSORS = 20;
 
-    enum class State { IDLE, READING, SCANNING };
+    enum class State { IDLE, READING, SCANNING, FETCHING };
 
     static constexpr size_t ADDR_LEN = 8;
 
@@ -139,6 +144,7 @@ class TemperatureSensor {
     static constexpr uint32_t CONVERSION_MS    = 1000; // 1 seconds
     static constexpr uint32_t READ_TIMEOUT_MS  = 2000; // 2 seconds
     static constexpr uint32_t SCAN_TIMEOUT_MS  = 3000; // 3 seconds
+    static constexpr uint32_t RESCAN_MS        = 60000; // 1 minute, known sensors are read directly in between
 
     static constexpr uint8_t CMD_CONVERT_TEMP    = 0x44;
     static constexpr uint8_t CMD_READ_SCRATCHPAD = 0xBE;
@@ -151,6 +157,7 @@ class TemperatureSensor {
     bool     temperature_convert_complete();
     int16_t  get_temperature_c(const uint8_t addr[]);
     uint64_t get_id(const uint8_t addr[]);
+    void     set_temperature(Sensor & sensor, int16_t t);
     void     remove_ha_topic(const std::string & id);
     void     addSensorJson(JsonObject output, const Sensor & sensor);
 
@@ -163,6 +170,9 @@ class TemperatureSensor {
     int8_t   scancnt_       = SCAN_START;
     uint8_t  firstscan_     = 0;
     int8_t   scanretry_     = 0;
+    uint32_t last_scan_     = 0;
+    bool     rescan_        = false; // a known sensor failed, search the bus again
+    uint8_t  fetch_         = 0;     // next known sensor to read
 #endif
 
     uint8_t  dallas_gpio_ = 0;
@@ -20,8 +20,53 @@
 
 #include "test.h"
 
+#ifdef EMSESP_STANDALONE
+#include <chrono>
+#include <fstream>
+#include <map>
+#include <sstream>
+#include <thread>
+
+// count the heap allocations made with new, so tests can report them
+static uint32_t heap_allocations = 0;
+
+void * operator new(size_t size) {
+    heap_allocations++;
+    void * p = malloc(size ? size : 1);
+    if (p == nullptr) {
+        throw std::bad_alloc();
+    }
+    return p;
+}
+
+// not inlined, otherwise gcc sees the free() and reports a mismatched new/delete
+__attribute__((noinline)) void operator delete(void * p) noexcept {
+    free(p);
+}
+#endif
+
 namespace emsesp {
 
+// captured bus traffic with a boiler, RC310, CR100 and SM100, without CRC
+static const char * bus_log[] = {
+    "08 00 18 00 00 02 5A 73 3D 0A 10 65 40 02 1A 80 00 01 E1 01 76 0E 3D 48 00 C9 44 02 00", // UBAMonitorFast
+    "08 00 19 00 00 C9 80 00 80 00 00 4F 00 00 00 00 01 4C 00 07 E5 00 00 00 00 00",          // UBAMonitorSlow
+    "08 00 34 00 2F 02 1C 02 1E 80 00 00 04 00 00 00 00 03 02 70 00 01 E5 3D",                // UBAMonitorWW
+    "08 10 33 00 23 24",                                                                      // boiler -> thermostat
+    "08 00 07 00 0B 80 00 00 00 00 00 00 00 00 00 00 00",                                     // UBADevices
+    "10 00 06 00 18 0B 0E 0D 04 0D 00",                                                       // RCTime
+    "10 00 FF 00 01 A5 80 00 01 30 28 00 30 28 01 54 03 03 01 01 54 02 A8 00 00 11 01 03",   // RCPLUSStatusMessage_HC1
+    "10 00 FF 00 01 B9 00 2E 26 26 1B 03 00 FF FF 05 28 01 E1 20 01 0F 05 2A",                // RC300Summer
+    "10 08 35 00 11 11",                                                                      // thermostat -> boiler
+    "10 00 FF 00 02 BA 01 02",                                                                // unknown EMS+ type
+    "18 10 FF 00 01 A5 00 CF 21 2E 00 00 2E 24 03 25 03 03 01 03 25 00 C8 00 00 11 01 03",   // remote -> master thermostat
+    "30 00 FF 00 02 64 00 00 00 04 00 00 FF 00 00 1E 0B 09 64 00 00 00 00",                   // SM100 modulation
+    "30 00 FF 0A 02 6A 04",                                                                   // SM100 pump
+    "30 00 FF 00 02 8E 00 00 00 00 00 00 06 C5 00 00 76 35",                                  // SM100Energy
+    "21 00 FF 00 02 D7 00 00 00",                                                             // unknown device
+    "0B 08 E4 00 01 02",                                                                      // us -> boiler
+};
+
 // no shell, called via the API or 'call system test' command
 // or http://ems-esp/api?device=system&cmd=test&data=boiler
 bool Test::test(const std::string & cmd, int8_t id1, int8_t id2) {
@@ -329,6 +374,11 @@ void Test::run_test(uuid::console::Shell & shell, const std::string & cmd, const
         shell.printfln("Testing memory by adding lots of devices and entities...");
         test("memory");
         shell.invoke_command("show values");
+        size_t entities = 0;
+        for (const auto & emsdevice : EMSESP::emsdevices) {
+            entities += emsdevice->count_entities();
+        }
+        shell.printfln("%d entities, each DeviceValue is %d bytes, %d bytes in total", entities, sizeof(DeviceValue), entities * sizeof(DeviceValue));
         ok = true;
     }
 
@@ -501,6 +551,770 @@ void Test::run_test(uuid::console::Shell & shell, const std::string & cmd, const
         ok = true;
     }
 
+    // hammer the lock-free Rx queue from two threads, like the UART task and the main loop
+    if (command == "rx_queue") {
+        shell.printfln("Testing Rx queue with 2 threads...");
+
+        static RxFrameQueue queue; // static, it's too big for the stack
+        const uint32_t      frames   = 100000;
+        uint32_t            received = 0;
+        uint32_t            errors   = 0;
+
+        std::thread producer([&]() {
+            uint8_t data[EMS_MAXBUFFERSIZE];
+            for (uint32_t n = 0; n < frames; n++) {
+                uint8_t length = 5 + (n % (EMS_MAXBUFFERSIZE - 4)); // 5..33 bytes
+                for (uint8_t i = 0; i < length; i++) {
+                    data[i] = (uint8_t)(n + i);
+                }
+                memcpy(data, &n, sizeof(n)); // sequence number in the first 4 bytes
+                queue.push(data, length);
+                if (n % 8 == 0) {
+                    std::this_thread::yield(); // give the consumer a chance, like the bus would
+                }
+            }
+        });
+
+        uint8_t  data[EMS_MAXBUFFERSIZE];
+        uint8_t  length;
+        uint32_t time_us;
+        uint32_t last = 0;
+        bool     more;
+        bool     done = false;
+        while (!done) {
+            done = (received + queue.overruns() >= frames) && queue.empty();
+            while (queue.pop(data, length, time_us, more)) {
+                uint32_t n;
+                memcpy(&n, data, sizeof(n));
+                if ((received && n <= last) || (length != 5 + (n % (EMS_MAXBUFFERSIZE - 4)))) {
+                    errors++;
+                }
+                for (uint8_t i = sizeof(n); i < length; i++) {
+                    if (data[i] != (uint8_t)(n + i)) {
+                        errors++;
+                        break;
+                    }
+                }
+                last = n;
+                received++;
+            }
+            std::this_thread::yield();
+        }
+        producer.join();
+
+        shell.printfln("Frames sent: %d, received: %d, overruns: %d, max queued: %d/%d",
+                       frames,
+                       received,
+                       queue.overruns(),
+                       queue.high_water(),
+                       RxFrameQueue::QUEUE_SIZE);
+        shell.printfln("Test %s (%d errors)", (errors == 0 && received + queue.overruns() == frames) ? "passed" : "FAILED", errors);
+        ok = true;
+    }
+
+    // replay a bus log through the old linear telegram lookup and the new dispatch index, and compare
+    if (command == "dispatch") {
+        shell.printfln("Testing telegram dispatch...");
+
+        add_device(0x08, 123); // GB072
+        add_device(0x10, 158); // RC310
+        add_device(0x18, 157); // CR100
+        add_device(0x30, 163); // SM100
+
+        // captured bus traffic, parsed into telegrams
+        auto telegrams = bus_capture();
+
+        // both paths must find the same device and handler
+        uint8_t errors = 0;
+        for (const auto & telegram : telegrams) {
+            EMSdevice * old_device = nullptr;
+            EMSdevice * new_device = nullptr;
+            bool        old_found  = EMSESP::dispatch_telegram_scan(telegram, old_device);
+            bool        new_found  = EMSESP::dispatch_telegram(telegram, new_device);
+            if (old_found != new_found || old_device != new_device) {
+                shell.printfln("Mismatch for type 0x%02X from 0x%02X to 0x%02X", telegram->type_id, telegram->src, telegram->dest);
+                errors++;
+            }
+        }
+
+        const uint32_t passes = 2000;
+        uint32_t       found  = 0;
+        EMSdevice *    emsdevice = nullptr;
+
+        auto start = std::chrono::steady_clock::now();
+        for (uint32_t i = 0; i < passes; i++) {
+            for (const auto & telegram : telegrams) {
+                found += EMSESP::dispatch_telegram_scan(telegram, emsdevice);
+            }
+        }
+        auto old_us = std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - start).count();
+
+        start = std::chrono::steady_clock::now();
+        for (uint32_t i = 0; i < passes; i++) {
+            for (const auto & telegram : telegrams) {
+                found -= EMSESP::dispatch_telegram(telegram, emsdevice);
+            }
+        }
+        auto new_us = std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - start).count();
+
+        uint32_t total = passes * telegrams.size();
+        shell.printfln("Dispatched %d telegrams, linear scan: %d us (%d ns each), index: %d us (%d ns each)",
+                       total,
+                       (uint32_t)old_us,
+                       (uint32_t)(old_us * 1000 / total),
+                       (uint32_t)new_us,
+                       (uint32_t)(new_us * 1000 / total));
+        shell.printfln("Test %s (%d errors)", (errors == 0 && found == 0) ? "passed" : "FAILED", errors);
+        ok = true;
+    }
+
+    // record the built-in bus capture and decode it again, or print a binary capture file as text for replay
+    if (command == "capture") {
+        auto & capture = EMSESP::rxservice_.capture();
+
+        if (!id1_s.empty()) {
+            std::ifstream file(id1_s, std::ios::binary);
+            std::string   content((std::istreambuf_iterator<char>(file)), std::istreambuf_iterator<char>());
+            bool          valid = RxCapture::decode((const uint8_t *)content.data(), content.size(), [&](uint32_t uptime_ms, const uint8_t * data, uint8_t length) {
+                std::vector<uint8_t> frame(data, data + length);
+                frame.push_back(EMSESP::rxservice_.calculate_crc(data, length));
+                shell.printfln("%s %s", uuid::log::format_timestamp_ms(uptime_ms, 3).c_str(), Helpers::data_to_hex(frame.data(), frame.size()).c_str());
+            });
+            if (!valid) {
+                shell.printfln("%s is not a valid capture", id1_s.c_str());
+            }
+            ok = true;
+        } else {
+            shell.printfln("Testing bus capture...");
+            uint8_t errors = 0;
+
+            // record the capture, with CRC errors in between which are not recorded
+            capture.start(EMSESP_DEFAULT_CAPTURE_SIZE);
+            for (auto line : bus_log) {
+                uart_telegram(line);
+                uart_telegram_withCRC("08 00 18 00 00 02 5A 73 3D 0A 10 65 40 02 1A 80 00 01 E1 01 76 0E 3D 48 00 C9 44 02 00 00");
+            }
+            errors += (capture.frames() != sizeof(bus_log) / sizeof(bus_log[0]));
+
+            size_t                   i        = 0;
+            std::vector<std::string> expected = std::vector<std::string>(std::begin(bus_log), std::end(bus_log));
+            auto                     snapshot = capture.snapshot();
+            errors += !RxCapture::decode(snapshot.data(), snapshot.size(), [&](uint32_t uptime_ms, const uint8_t * data, uint8_t length) {
+                errors += (i >= expected.size() || Helpers::data_to_hex(data, length) != expected[i]);
+                i++;
+            });
+            errors += (i != expected.size());
+            size_t text = 0;
+            for (const auto & line : expected) {
+                text += 17 + line.size() + 4; // timestamp, frame and CRC, like the 'watch raw' output
+            }
+            shell.printfln("Recorded %d telegrams in %d bytes (%d bytes as text)", capture.frames(), snapshot.size(), text);
+
+            // a small ring keeps the newest telegrams, with the times of the frames still right
+            capture.start(200);
+            for (uint8_t n = 0; n < 20; n++) {
+                uart_telegram(bus_log[n % 4]);
+            }
+            snapshot          = capture.snapshot();
+            i                 = 0;
+            uint32_t last     = 0;
+            uint32_t received = 0;
+            errors += !RxCapture::decode(snapshot.data(), snapshot.size(), [&](uint32_t uptime_ms, const uint8_t * data, uint8_t length) {
+                errors += (uptime_ms < last);
+                last = uptime_ms;
+                received++;
+            });
+            shell.printfln("Small ring: %d telegrams kept, %d dropped, %d bytes used", received, capture.dropped(), capture.used());
+            errors += (received != capture.frames() || received + capture.dropped() != 20 || capture.used() > capture.capacity());
+            errors += (snapshot.size() != RxCapture::HEADER_SIZE + capture.used());
+
+            capture.stop();
+            shell.printfln("Test %s (%d errors)", errors == 0 ? "passed" : "FAILED", errors);
+            ok = true;
+        }
+    }
+
+    // replay a bus capture file, e.g. "test replay capture.txt" or "test replay capture.txt realtime"
+    if (command == "replay") {
+        replay(shell, id1_s, id2_s == "realtime");
+        ok = true;
+    }
+
+    // replay a bus log through the trace log statements of the Rx path, with trace switched off
+    if (command == "log_lazy") {
+        shell.printfln("Testing lazy log formatting...");
+
+        add_device(0x08, 123); // GB072
+        add_device(0x10, 158); // RC310
+        add_device(0x18, 157); // CR100
+        add_device(0x30, 163); // SM100
+
+        auto telegrams = bus_capture();
+
+        // a logger below trace, like the default settings
+        uuid::log::Logger logger_{"test"};
+        logger_.level(uuid::log::Level::INFO);
+
+        // the arguments must not be evaluated
+        uint8_t  errors    = 0;
+        uint32_t evaluated = 0;
+        auto     count     = [&evaluated]() { return ++evaluated; };
+        LOG_TRACE("%d", count());
+        LOG_DEBUG("%d", count());
+        errors += (evaluated != 0);
+        LOG_INFO("lazy log test %d", count());
+        errors += (evaluated != 1);
+
+        const uint32_t passes = 500;
+        uint32_t       bytes  = 0;
+
+        auto start = std::chrono::steady_clock::now();
+        for (uint32_t i = 0; i < passes; i++) {
+            for (const auto & telegram : telegrams) {
+                std::string hex = Helpers::data_to_hex(telegram->message_data, telegram->message_length);
+                logger_.trace("Rx: %s", hex.c_str());
+                std::string pretty = EMSESP::pretty_telegram(telegram);
+                logger_.trace("%s", pretty.c_str());
+                bytes += hex.size() + pretty.size();
+            }
+        }
+        auto eager_us = std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - start).count();
+
+        start = std::chrono::steady_clock::now();
+        for (uint32_t i = 0; i < passes; i++) {
+            for (const auto & telegram : telegrams) {
+                LOG_TRACE("Rx: %s", Helpers::data_to_hex(telegram->message_data, telegram->message_length).c_str());
+                LOG_TRACE("%s", EMSESP::pretty_telegram(telegram).c_str());
+            }
+        }
+        auto lazy_us = std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - start).count();
+
+        uint32_t total = passes * telegrams.size();
+        shell.printfln("Logged %d telegrams at trace (%d bytes formatted), eager: %d us (%d ns each), lazy: %d us (%d ns each)",
+                       total,
+                       bytes,
+                       (uint32_t)eager_us,
+                       (uint32_t)(eager_us * 1000 / total),
+                       (uint32_t)lazy_us,
+                       (uint32_t)(lazy_us * 1000 / total));
+        shell.printfln("Test %s (%d errors)", errors == 0 ? "passed" : "FAILED", errors);
+        ok = true;
+    }
+
+    // Tx queue priority classes, coalescing of reads and superseding of writes
+    if (command == "tx_queue") {
+        shell.printfln("Testing Tx queue...");
+        uint8_t errors = 0;
+        auto &  tx     = EMSESP::txservice_;
+
+        uint8_t high  = tx.queue_size(TxService::PRIORITY_HIGH);
+        uint8_t user  = tx.queue_size(TxService::PRIORITY_USER);
+        uint8_t fetch = tx.queue_size(TxService::PRIORITY_FETCH);
+
+        // a fetch of three telegrams
+        tx.read_priority(TxService::PRIORITY_FETCH);
+        tx.read_request(0x0300, 0x30);
+        tx.read_request(0x0301, 0x30);
+        tx.read_request(0x0302, 0x30);
+        tx.read_request(0x0300, 0x30); // already queued
+        tx.read_priority(TxService::PRIORITY_USER);
+
+        // a user read of a fetched telegram moves it up, twice is only sent once
+        tx.read_request(0x0301, 0x30);
+        tx.read_request(0x0301, 0x30);
+        errors += (tx.reads_coalesced() != 3);
+
+        // the second write replaces the first
+        uint8_t value = 1;
+        tx.add(Telegram::Operation::TX_WRITE, 0x30, 0x0358, 0, &value, 1, 0);
+        value = 2;
+        tx.add(Telegram::Operation::TX_WRITE, 0x30, 0x0358, 0, &value, 1, 0);
+        errors += (tx.writes_superseded() != 1);
+
+        errors += (tx.queue_size(TxService::PRIORITY_HIGH) != high + 1 || tx.queue_size(TxService::PRIORITY_USER) != user + 1
+                   || tx.queue_size(TxService::PRIORITY_FETCH) != fetch + 2);
+
+        std::vector<uint16_t> order;
+        for (const auto & it : tx.queue()) {
+            if (it.telegram_->dest == 0x30) {
+                order.push_back(it.telegram_->type_id);
+                if (it.telegram_->type_id == 0x0358) {
+                    errors += (it.telegram_->message_data[0] != 2);
+                }
+            }
+        }
+        errors += (order != std::vector<uint16_t>{0x0358, 0x0301, 0x0300, 0x0302});
+
+        // a full queue drops the newest fetch to make room for a user read
+        tx.read_priority(TxService::PRIORITY_FETCH);
+        for (uint16_t type_id = 0x0400; tx.queue().size() < MAX_TX_TELEGRAMS; type_id++) {
+            tx.read_request(type_id, 0x30);
+        }
+        tx.read_priority(TxService::PRIORITY_USER);
+        uint16_t newest = tx.queue().back().telegram_->type_id;
+        tx.read_request(0x0500, 0x30);
+        auto queue = tx.queue();
+        errors += (queue.size() != MAX_TX_TELEGRAMS || queue.back().telegram_->type_id == newest);
+        errors += (std::none_of(queue.begin(), queue.end(), [](const TxService::QueuedTxTelegram & it) { return it.telegram_->type_id == 0x0500; }));
+
+        shell.printfln("Queue high/user/fetch: %d/%d/%d, reads coalesced: %d, writes superseded: %d",
+                       tx.queue_size(TxService::PRIORITY_HIGH),
+                       tx.queue_size(TxService::PRIORITY_USER),
+                       tx.queue_size(TxService::PRIORITY_FETCH),
+                       tx.reads_coalesced(),
+                       tx.writes_superseded());
+        shell.printfln("Test %s (%d errors)", errors == 0 ? "passed" : "FAILED", errors);
+        ok = true;
+    }
+
+    // scheduled fetches of a boiler that answers every read, with only the total uptime changing
+    if (command == "fetch") {
+        shell.printfln("Testing adaptive fetch...");
+        uint8_t errors = 0;
+        auto &  tx     = EMSESP::txservice_;
+
+        add_device(0x08, 123); // GB072
+        uint8_t share = tx.pacer().share();
+        tx.pacer().share(100); // send right away
+        EMSdevice * boiler = nullptr;
+        for (const auto & emsdevice : EMSESP::emsdevices) {
+            if (emsdevice->is_device_id(0x08)) {
+                boiler = emsdevice.get();
+            }
+        }
+        while (!tx.tx_queue_empty()) {
+            tx.send();
+        }
+
+        const uint8_t cycles    = 60;
+        uint32_t      per_cycle = 0;
+        uint32_t      reads     = 0;
+        uint32_t      fast      = 0;
+        for (uint8_t cycle = 0; cycle < cycles; cycle++) {
+            boiler->fetch_values(true);
+            auto queue = tx.queue();
+            while (!tx.tx_queue_empty()) {
+                tx.send();
+            }
+            per_cycle = cycle ? per_cycle : queue.size();
+            reads += queue.size();
+            for (const auto & it : queue) {
+                uint16_t             type_id = it.telegram_->type_id;
+                std::vector<uint8_t> answer  = {0x08, EMSESP_DEFAULT_EMS_BUS_ID};
+                if (type_id > 0xFF) {
+                    answer.insert(answer.end(), {0xFF, 0, (uint8_t)((type_id >> 8) - 1), (uint8_t)(type_id & 0xFF)});
+                } else {
+                    answer.insert(answer.end(), {(uint8_t)type_id, 0});
+                }
+                answer.insert(answer.end(), 20, 0);
+                if (type_id == 0x14) {
+                    answer[6] = cycle; // UBATotalUptime, minutes
+                    fast++;
+                }
+                uart_telegram(answer);
+            }
+        }
+        errors += (fast != cycles);          // the changing telegram is read every cycle
+        errors += (reads * 4 > per_cycle * cycles); // and most of the others are not
+
+        shell.printfln("Reads in %d cycles: %d fixed, %d adaptive (%d skipped)", cycles, per_cycle * cycles, reads, EMSdevice::fetch_skipped());
+        tx.pacer().share(share);
+        shell.printfln("Test %s (%d errors)", errors == 0 ? "passed" : "FAILED", errors);
+        ok = true;
+    }
+
+    // bus utilization of a simulated bus, and pacing of our own Tx to a share of the bus time
+    if (command == "busload") {
+        shell.printfln("Testing bus load and Tx pacing...");
+        uint8_t errors = 0;
+
+        // 10 frames of 29 bytes per second from others and 5 replies of 19 bytes to us
+        BusLoad load;
+        for (uint32_t ms = 0; ms < 20000; ms += 100) {
+            load.add(ms, 29, false);
+            if (ms % 200 == 0) {
+                load.add(ms + 50, 19, true);
+            }
+        }
+        uint8_t expected = (10 * BusLoad::frame_us(29) + 5 * BusLoad::frame_us(19)) / 10000;
+        uint8_t own      = 5 * BusLoad::frame_us(19) / 10000;
+        shell.printfln("Bus load %d%% (expected %d%%), own %d%% (expected %d%%)", load.utilization(20000), expected, load.own_utilization(20000), own);
+        errors += (load.utilization(20000) + 1 < expected || load.utilization(20000) > expected + 1);
+        errors += (load.own_utilization(20000) + 1 < own || load.own_utilization(20000) > own + 1);
+        errors += (load.utilization(40000) != 0); // idle for long enough
+
+        // the polls and single byte replies count as well, 1000 of them are 2 s of bus time
+        auto &   rx_load = EMSESP::rxservice_.bus_load();
+        uint32_t now     = ::millis();
+        uint8_t  before  = rx_load.utilization(now);
+        uint8_t  poll    = 0x8B;
+        for (uint16_t i = 0; i < 1000; i++) {
+            EMSESP::incoming_telegram(&poll, 1);
+        }
+        shell.printfln("Bus load after 1000 polls: %d%% (was %d%%)", rx_load.utilization(now), before);
+        errors += (rx_load.utilization(now) < before + 15);
+
+        // polled every 50 ms for a minute, reading 25 bytes each time
+        // the share is of the bus time the other devices leave free
+        uint8_t  length   = 25;
+        auto     telegram = std::make_shared<Telegram>(Telegram::Operation::TX_READ, 0x0B, 0x08, 0x18, 0, &length, 1);
+        uint32_t cost     = TxService::bus_time(*telegram);
+        for (uint8_t busy : {0, 40}) {
+            for (uint8_t share : {10, 25, 50, 100}) {
+                TxPacer  pacer;
+                uint32_t sent = 0;
+                pacer.share(share);
+                for (uint32_t ms = 0; ms < 60000; ms += 50) {
+                    sent += pacer.allow(ms, cost, busy);
+                }
+                uint32_t used     = (uint64_t)sent * cost / 600000; // % of the minute
+                uint32_t expected = share * (100 - busy) / 100;
+                shell.printfln("Busy %2d%%, share %3d%%: sent %d of %d, %d%% of the bus time, %d deferred", busy, share, sent, 1200, used, pacer.deferred());
+                errors += (share < 100 && used > expected);
+                errors += (share < 100 && used + 2 < expected);
+                errors += (share == 100 && sent != 1200);
+            }
+        }
+
+        shell.printfln("Test %s (%d errors)", errors == 0 ? "passed" : "FAILED", errors);
+        ok = true;
+    }
+
+    // a long RC310 telegram read in two parts, processed once as a whole
+    if (command == "assemble") {
+        shell.printfln("Testing assembly of long telegrams...");
+        uint8_t errors = 0;
+        auto &  rx     = EMSESP::rxservice_;
+
+        add_device(0x10, 158); // RC310
+        uart_telegram("90 00 FF 00 01 A5 80 00 01 30 28 00 30 28 01 54 03 03 01 01 54 02 A8 00 00 11 01 03"); // hc1
+
+        // RC300Set of hc1, the cooling flag is at offset 28 in the second part
+        std::vector<uint8_t> first = {0x10, EMSESP_DEFAULT_EMS_BUS_ID, 0xFF, 0, 0x01, 0xB9};
+        first.insert(first.end(), 25, 0);
+        std::vector<uint8_t> second = {0x10, EMSESP_DEFAULT_EMS_BUS_ID, 0xFF, 25, 0x01, 0xB9, 0, 0, 0, 1, 0};
+
+        // not read in parts, so the first part is processed by itself
+        uint32_t assembled = rx.blocks_assembled();
+        uart_telegram(first);
+        errors += (rx.blocks_assembled() != assembled);
+
+        // read as by the scheduled fetch, the reply fills the frame so Tx reads the next part
+        auto &  tx    = EMSESP::txservice_;
+        uint8_t share = tx.pacer().share();
+        tx.pacer().share(100); // send right away
+        while (!tx.tx_queue_empty()) {
+            tx.send();
+        }
+        tx.read_request(0x02B9, 0x10);
+        tx.send();
+        uart_telegram(first);
+        errors += (rx.blocks_assembled() != assembled);
+        errors += (tx.tx_queue_empty() || tx.queue().front().telegram_->type_id != 0x02B9 || tx.queue().front().telegram_->offset != 25);
+        tx.send();
+        uart_telegram(second);
+        errors += (rx.blocks_assembled() != assembled + 1);
+        tx.pacer().share(share);
+
+        JsonDocument doc;
+        JsonObject   root = doc.to<JsonObject>();
+        errors += !EMSESP::get_device_value_info(root, "cooling", 1, EMSdevice::DeviceType::THERMOSTAT);
+        errors += (root["value"] != "on");
+        shell.printfln("Blocks assembled: %d, hc1 cooling: %s", rx.blocks_assembled() - assembled, root["value"].as<std::string>().c_str());
+
+        shell.printfln("Test %s (%d errors)", errors == 0 ? "passed" : "FAILED", errors);
+        ok = true;
+    }
+
+    // run a bus log through the Rx path and check the latency probes of each stage
+    if (command == "perf") {
+        shell.printfln("Testing latency probes...");
+        uint8_t errors = 0;
+
+        // percentiles, 990 fast samples and 10 slow ones
+        LatencyStat stat;
+        for (uint16_t i = 0; i < 990; i++) {
+            stat.add(100);
+        }
+        for (uint8_t i = 0; i < 10; i++) {
+            stat.add(5000);
+        }
+        errors += (stat.count() != 1000 || stat.min() != 100 || stat.max() != 5000 || stat.avg() != 149);
+        errors += (stat.p99() < 100 || stat.p99() > 127);
+        stat.add(6000);
+        errors += (stat.p99() < 4096 || stat.p99() > 6000);
+
+        add_device(0x08, 123); // GB072
+        add_device(0x10, 158); // RC310
+        add_device(0x30, 163); // SM100
+
+        Perf::reset();
+        for (auto line : bus_log) {
+            uart_telegram(line);
+        }
+        uint32_t frames = sizeof(bus_log) / sizeof(bus_log[0]);
+        errors += (Perf::stat(Perf::RX_QUEUE).count() != frames || Perf::stat(Perf::PROCESS).count() != frames);
+
+        // the boiler values changed, so its publish has a waiting time
+        EMSESP::publish_device_values(EMSdevice::DeviceType::BOILER);
+        errors += (Perf::stat(Perf::PUBLISH_WAIT).count() != 1 || Perf::stat(Perf::PUBLISH_BUILD).count() != 1);
+        EMSESP::publish_device_values(EMSdevice::DeviceType::BOILER);
+        errors += (Perf::stat(Perf::PUBLISH_WAIT).count() != 1 || Perf::stat(Perf::PUBLISH_BUILD).count() != 2);
+
+        // acks come in order, a lost one is skipped
+        Perf::mqtt_queued(1);
+        Perf::mqtt_queued(2);
+        Perf::mqtt_queued(3);
+        Perf::mqtt_acked(2);
+        Perf::mqtt_acked(3);
+        Perf::mqtt_acked(1);
+        errors += (Perf::stat(Perf::MQTT_ACK).count() != 2);
+
+        Perf::show(shell);
+        JsonDocument doc;
+        Perf::info(doc.to<JsonObject>());
+        errors += !doc["process count"].is<uint32_t>() || doc["uart count"].is<uint32_t>();
+
+        shell.printfln("Test %s (%d errors)", errors == 0 ? "passed" : "FAILED", errors);
+        ok = true;
+    }
+
+    if (command == "find_command") {
+        shell.printfln("Testing command lookup...");
+
+        add_device(0x08, 123); // GB072
+        add_device(0x10, 158); // RC310
+
+        // RC310 HC1 status, this registers the hc1 commands
+        uart_telegram("90 00 FF 00 01 A5 80 00 01 30 28 00 30 28 01 54 03 03 01 01 54 02 A8 00 00 11 01 03");
+
+        // the index must find the same command as the linear scan, also in upper case
+        std::vector<std::pair<uint8_t, std::string>> names;
+        for (const auto & cf : Command::commands()) {
+            names.emplace_back(cf.device_type_, cf.cmd_);
+            std::string upper = cf.cmd_;
+            std::transform(upper.begin(), upper.end(), upper.begin(), ::toupper);
+            names.emplace_back(cf.device_type_, upper);
+        }
+        names.emplace_back(EMSdevice::DeviceType::THERMOSTAT, "nosuchcommand");
+
+        uint8_t errors = 0;
+        for (const auto & name : names) {
+            if (Command::find_command(name.first, 0, name.second.c_str()) != Command::find_command_scan(name.first, 0, name.second.c_str())) {
+                shell.printfln("Mismatch for %s", name.second.c_str());
+                errors++;
+            }
+        }
+
+        const uint32_t passes = 100;
+        uint32_t       found  = 0;
+
+        auto start = std::chrono::steady_clock::now();
+        for (uint32_t i = 0; i < passes; i++) {
+            for (const auto & name : names) {
+                found += Command::find_command_scan(name.first, 0, name.second.c_str()) != nullptr;
+            }
+        }
+        auto old_us = std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - start).count();
+
+        start = std::chrono::steady_clock::now();
+        for (uint32_t i = 0; i < passes; i++) {
+            for (const auto & name : names) {
+                found -= Command::find_command(name.first, 0, name.second.c_str()) != nullptr;
+            }
+        }
+        auto new_us = std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - start).count();
+
+        uint32_t total = passes * names.size();
+        shell.printfln("Looked up %d commands (%d registered), linear scan: %d us (%d ns each), index: %d us (%d ns each)",
+                       total,
+                       Command::commands().size(),
+                       (uint32_t)old_us,
+                       (uint32_t)(old_us * 1000 / total),
+                       (uint32_t)new_us,
+                       (uint32_t)(new_us * 1000 / total));
+
+        // full API path processing, reading entity values
+        const char * paths[] = {"api/thermostat/hc1/seltemp", "api/thermostat/hc1/mode", "api/boiler/curflowtemp", "api/boiler/selflowtemp"};
+        const uint32_t calls = 500;
+        uint32_t       fails = 0;
+        start                = std::chrono::steady_clock::now();
+        for (uint32_t i = 0; i < calls; i++) {
+            for (auto path : paths) {
+                JsonDocument doc_in;
+                JsonDocument doc_out;
+                fails += Command::process(path, true, doc_in.to<JsonObject>(), doc_out.to<JsonObject>()) != CommandRet::OK;
+            }
+        }
+        auto process_us = std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - start).count();
+        total           = calls * (sizeof(paths) / sizeof(paths[0]));
+        shell.printfln("Processed %d API paths in %d us (%d ns each)", total, (uint32_t)process_us, (uint32_t)(process_us * 1000 / total));
+
+        shell.printfln("Test %s (%d errors)", (errors == 0 && found == 0 && fails == 0) ? "passed" : "FAILED", errors + fails);
+        ok = true;
+    }
+
+    if (command == "path_parser") {
+        shell.printfln("Testing path parser...");
+
+        add_device(0x08, 123); // GB072
+        add_device(0x10, 158); // RC310
+
+        // RC310 HC1 status, this registers the hc1 commands
+        uart_telegram("90 00 FF 00 01 A5 80 00 01 30 28 00 30 28 01 54 03 03 01 01 54 02 A8 00 00 11 01 03");
+
+        // both parsers must give the same folders
+        const char * urls[] = {"/api/thermostat/hc1/seltemp",
+                               "api/boiler//wwseltemp/",
+                               "/api/system/info?x=1&y=2",
+                               "ems-esp/thermostat/hc2/mode",
+                               "/api/thermostat/hc1/seltemp/value",
+                               "/api"};
+        uint8_t      errors = 0;
+        for (auto url : urls) {
+            SUrlParser old_p;
+            PathParser new_p;
+            old_p.parse(url);
+            new_p.parse(url);
+            bool same = (old_p.paths().size() == new_p.size());
+            for (uint8_t i = 0; same && i < new_p.size(); i++) {
+                same = new_p[i].equals(old_p.paths()[i].c_str());
+            }
+            if (!same) {
+                shell.printfln("Mismatch for %s", url);
+                errors++;
+            }
+        }
+
+        const uint32_t passes = 1000;
+        uint32_t       start  = heap_allocations;
+        for (uint32_t i = 0; i < passes; i++) {
+            SUrlParser p;
+            p.parse(urls[0]);
+        }
+        uint32_t old_allocs = heap_allocations - start;
+
+        start = heap_allocations;
+        for (uint32_t i = 0; i < passes; i++) {
+            PathParser p;
+            p.parse(urls[0]);
+        }
+        uint32_t new_allocs = heap_allocations - start;
+        shell.printfln("Heap allocations parsing %s, SUrlParser: %d, PathParser: %d", urls[0], old_allocs / passes, new_allocs / passes);
+
+        // full API calls, reading and writing entity values. The JSON documents allocate with malloc and are not counted
+        const char * paths[] = {"/api/thermostat/hc1/seltemp", "ems-esp/thermostat/hc1/seltemp", "/api/boiler/selflowtemp"};
+        for (auto path : paths) {
+            JsonDocument doc_in;
+            JsonDocument doc_out;
+            start                 = heap_allocations;
+            uint8_t  read         = Command::process(path, true, doc_in.to<JsonObject>(), doc_out.to<JsonObject>());
+            uint32_t read_allocs  = heap_allocations - start;
+            doc_in["value"]       = 21;
+            start                 = heap_allocations;
+            uint8_t  write        = Command::process(path, true, doc_in.as<JsonObject>(), doc_out.to<JsonObject>());
+            uint32_t write_allocs = heap_allocations - start;
+            shell.printfln("Heap allocations for %s, read: %d, write: %d", path, read_allocs, write_allocs);
+            if (read != CommandRet::OK || write != CommandRet::OK) {
+                shell.printfln("Command failed for %s", path);
+                errors++;
+            }
+        }
+
+        shell.printfln("Test %s (%d errors)", errors == 0 ? "passed" : "FAILED", errors);
+        ok = true;
+    }
+
+    if (command == "mqtt_subscribe") {
+        shell.printfln("Testing MQTT subscription routing...");
+
+        // register a few hundred set topics, like Home Assistant would replay on a reconnect
+        // the subscriptions stay registered after the test, so the callbacks count in a static
+        const uint16_t  num_topics = 300;
+        static uint32_t received;
+        received = 0;
+        for (uint16_t i = 0; i < num_topics; i++) {
+            Mqtt::subscribe(EMSdevice::DeviceType::CUSTOM, "test/topic" + std::to_string(i), [](const char * message) {
+                received++;
+                return true;
+            });
+        }
+        Mqtt::subscribe(EMSdevice::DeviceType::CUSTOM, "test/topic0", nullptr); // already there, must not be added again
+
+        const uint32_t passes = 10;
+        auto           start  = std::chrono::steady_clock::now();
+        for (uint32_t i = 0; i < passes; i++) {
+            for (uint16_t j = 0; j < num_topics; j++) {
+                std::string topic = Mqtt::base() + "/test/topic" + std::to_string(j);
+                EMSESP::mqtt_.incoming(topic.c_str(), "1");
+            }
+        }
+        auto us = std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - start).count();
+
+        uint32_t total = passes * num_topics;
+        shell.printfln("Routed %d messages over %d subscriptions in %d us (%d ns each)", total, num_topics, (uint32_t)us, (uint32_t)(us * 1000 / total));
+        shell.printfln("Test %s (%d of %d received)", received == total ? "passed" : "FAILED", received, total);
+        ok = true;
+    }
+
+    if (command == "customization_lookup") {
+        shell.printfln("Testing entity customization lookup...");
+
+        add_device(0x08, 123); // GB072
+
+        // give every boiler entity a custom name, and add 8 more devices with 100 customized entities each
+        EntityCustomization boiler_custom;
+        boiler_custom.product_id = 123;
+        boiler_custom.device_id  = 0x08;
+        {
+            EMSESP::webCustomizationService.update([&](WebCustomization & settings) {
+                settings.entityCustomizations.clear();
+                return StateUpdateResult::CHANGED;
+            });
+            auto boiler = EMSFactory::add(EMSdevice::DeviceType::BOILER, 0x08, 123, "01.00", "GB072", EMSdevice::EMS_DEVICE_FLAG_NONE, EMSdevice::Brand::NO_BRAND);
+            for (const auto & cf : Command::commands()) {
+                if (cf.device_type_ == EMSdevice::DeviceType::BOILER) {
+                    boiler->setCustomizationEntity(std::string("00") + cf.cmd_ + "|my " + cf.cmd_);
+                }
+            }
+            boiler->getCustomizationEntities(boiler_custom);
+        }
+        uint16_t num_custom = boiler_custom.entity_ids.size();
+
+        EMSESP::webCustomizationService.update([&](WebCustomization & settings) {
+            settings.entityCustomizations.push_back(boiler_custom);
+            for (uint8_t i = 1; i <= 8; i++) {
+                auto other       = EntityCustomization();
+                other.product_id = i;
+                other.device_id  = 0x20 + i;
+                for (uint8_t j = 0; j < 100; j++) {
+                    other.entity_ids.push_back("08entity" + std::to_string(j) + "|custom name");
+                }
+                other.build_index();
+                settings.entityCustomizations.push_back(other);
+            }
+            return StateUpdateResult::CHANGED;
+        });
+
+        // create the boiler again and again, which registers all its entities
+        const uint32_t passes = 20;
+        uint16_t       found  = 0;
+        auto           start  = std::chrono::steady_clock::now();
+        for (uint32_t i = 0; i < passes; i++) {
+            auto boiler = EMSFactory::add(EMSdevice::DeviceType::BOILER, 0x08, 123, "01.00", "GB072", EMSdevice::EMS_DEVICE_FLAG_NONE, EMSdevice::Brand::NO_BRAND);
+            if (i == 0) {
+                EntityCustomization custom;
+                boiler->getCustomizationEntities(custom);
+                found = (custom.entity_ids == boiler_custom.entity_ids) ? custom.entity_ids.size() : 0;
+            }
+        }
+        auto us = std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - start).count();
+
+        shell.printfln("Created %d boilers with %d customized entities in %d us (%d us each)", passes, num_custom, (uint32_t)us, (uint32_t)(us / passes));
+        shell.printfln("Test %s (%d of %d customized)", found == num_custom ? "passed" : "FAILED", found, num_custom);
+        ok = true;
+    }
+
     if (command == "devices") {
         shell.printfln("Testing devices...");
 
@@ -720,6 +1534,255 @@ void Test::run_test(uuid::console::Shell & shell, const std::string & cmd, const
         ok = true;
     }
 
+    if (command == "weblog") {
+        shell.printfln("Testing batched web log");
+        auto &                weblog = EMSESP::webLogService;
+        AsyncWebServerRequest request;
+        uint8_t               errors = 0;
+
+        weblog.fetchLog(&request);
+        weblog.max_batch_   = 20;
+        weblog.batch_bytes_ = 2048;
+        for (uint8_t i = 0; i < 60; i++) {
+            EMSESP::logger().info("log message %d", i);
+        }
+
+        // the buffer holds 50, so the first 10 plus the messages before the test are dropped
+        uint16_t events = 0, entries = 0;
+        while (uuid::log::Logger::pending(weblog.log_cursor_) && events < 100) {
+            weblog.last_transmit_ = uuid::get_uptime_ms() - WebLogService::REFRESH_SYNC;
+            weblog.loop();
+            JsonDocument doc;
+            deserializeJson(doc, weblog.transmit_buffer_);
+            shell.printfln("event %d: %d entries, %d bytes, %d dropped, %d waiting",
+                           events,
+                           doc["e"].size(),
+                           weblog.transmit_buffer_.size(),
+                           doc["d"].as<uint16_t>(),
+                           doc["p"].as<uint16_t>());
+            errors += (doc["e"].size() > weblog.max_batch_);
+            entries += doc["e"].size();
+            events++;
+        }
+        errors += (entries != weblog.maximum_log_messages());
+
+        // a small byte budget splits the batches, but always sends at least one message
+        weblog.fetchLog(&request);
+        weblog.batch_bytes_   = 50;
+        weblog.last_transmit_ = uuid::get_uptime_ms() - WebLogService::REFRESH_SYNC;
+        weblog.loop();
+        JsonDocument doc;
+        deserializeJson(doc, weblog.transmit_buffer_);
+        shell.printfln("small budget: %d entries", doc["e"].size());
+        errors += (doc["e"].size() != 1);
+
+        weblog.batch_bytes_ = 2048;
+        shell.printfln("Test %s (%d errors)", errors == 0 ? "passed" : "FAILED", errors);
+        ok = true;
+    }
+
+    if (command == "log_ring") {
+        shell.printfln("Testing the shared log ring");
+        uint8_t errors = 0;
+
+        // make sure debug messages are stored
+        const uuid::log::Level shell_level = shell.log_level();
+        shell.log_level(uuid::log::Level::DEBUG);
+
+        // a reader at the end only sees new messages
+        uuid::log::Cursor cursor = uuid::log::Logger::cursor_end();
+        EMSESP::logger().info("ring message");
+        EMSESP::logger().debug("ring debug message");
+        uuid::log::Record record;
+        errors += !uuid::log::Logger::read(cursor, uuid::log::Level::INFO, record);
+        errors += (strcmp(record.text, "ring message") != 0);
+        errors += uuid::log::Logger::read(cursor, uuid::log::Level::INFO, record); // debug is filtered
+        errors += (uuid::log::Logger::pending(cursor) != 0);
+
+        // wrap the ring several times, the reader is told how many it missed
+        const unsigned long start = record.id + 2; // after the debug message
+        char                text[200];
+        memset(text, 'x', sizeof(text) - 1);
+        text[sizeof(text) - 1] = '\0';
+        for (uint16_t i = 0; i < 500; i++) {
+            EMSESP::logger().info("%d %s", i, text);
+        }
+        unsigned long read = 0;
+        while (uuid::log::Logger::read(cursor, uuid::log::Level::INFO, record)) {
+            read++;
+        }
+        shell.printfln("read %lu, dropped %lu, last id %lu", read, cursor.dropped, record.id);
+        errors += (read == 0 || read + cursor.dropped != 500);
+        errors += (record.id != start + 499);
+        errors += (strncmp(record.text, "499 ", 4) != 0);
+
+        // the last n messages
+        cursor = uuid::log::Logger::cursor_last(5);
+        errors += (uuid::log::Logger::pending(cursor) != 5);
+
+        // a flood of debug messages doesn't push out the info history, nor counts as dropped for an info reader
+        EMSESP::logger().info("before the flood");
+        cursor = uuid::log::Logger::cursor_end();
+        for (uint16_t i = 0; i < 500; i++) {
+            EMSESP::logger().debug("%d %s", i, text);
+        }
+        EMSESP::logger().info("after the flood");
+        errors += (uuid::log::Logger::pending(cursor, uuid::log::Level::INFO) != 1);
+        errors += !uuid::log::Logger::read(cursor, uuid::log::Level::INFO, record);
+        errors += (strcmp(record.text, "after the flood") != 0 || cursor.dropped != 0);
+        cursor = uuid::log::Logger::cursor_last(2, uuid::log::Level::INFO);
+        errors += (uuid::log::Logger::pending(cursor, uuid::log::Level::INFO) != 2);
+        errors += !uuid::log::Logger::read(cursor, uuid::log::Level::INFO, record);
+        errors += (strcmp(record.text, "before the flood") != 0);
+
+        shell.log_level(shell_level);
+
+        shell.printfln("Test %s (%d errors)", errors == 0 ? "passed" : "FAILED", errors);
+        ok = true;
+    }
+
+    if (command == "deferred") {
+        shell.printfln("Testing deferred dashboard data after a write");
+
+        test("boiler");
+        uint8_t unique_id = EMSESP::emsdevices.back()->unique_id();
+
+        AsyncWebServerRequest request;
+        uint8_t               errors = 0;
+        uint8_t               buffer[100];
+
+        // a write is waiting for its validate telegram, the response waits for the data
+        EMSESP::wait_validate(0x33);
+        EMSESP::webDataService.device_data(&request, unique_id);
+        EMSESP::webDataService.loop();
+        shell.printfln("parked: %d", EMSESP::webDataService.deferred_.size());
+        errors += (EMSESP::webDataService.deferred_.size() != 1);
+        errors += (request._filler(buffer, sizeof(buffer), 0) != RESPONSE_TRY_AGAIN);
+
+        // the validate telegram arrives, the data is built in the same loop and the response can go out
+        uart_telegram({0x08, 0x0B, 0x33, 0x00, 0x08, 0xFF, 0x34, 0xFB, 0x00, 0x28, 0x00, 0x00, 0x46, 0x00, 0xFF, 0xFF, 0x00});
+        EMSESP::webDataService.loop();
+        shell.printfln("after validate: %d", EMSESP::webDataService.deferred_.size());
+        errors += (EMSESP::webDataService.deferred_.size() != 0) + EMSESP::wait_validate();
+        size_t len = request._filler(buffer, sizeof(buffer), 0);
+        errors += (len == 0 || len == RESPONSE_TRY_AGAIN || request._filler(buffer, sizeof(buffer), len) != 0);
+
+        // no validate telegram, the request is sent on timeout
+        EMSESP::wait_validate(0x33);
+        EMSESP::webDataService.device_data(&request, unique_id);
+        EMSESP::webDataService.device_data(&request, unique_id);
+        EMSESP::webDataService.loop();
+        errors += (EMSESP::webDataService.deferred_.size() != 2);
+        EMSESP::webDataService.deferred_.front()->since -= TxService::POST_SEND_DELAY + 500;
+        EMSESP::webDataService.loop();
+        shell.printfln("after timeout: %d", EMSESP::webDataService.deferred_.size());
+        errors += (EMSESP::webDataService.deferred_.size() != 0) + EMSESP::wait_validate();
+
+        // nothing to wait for, sent right away
+        EMSESP::webDataService.device_data(&request, unique_id);
+        errors += (EMSESP::webDataService.deferred_.size() != 0);
+
+        // an unknown device gets its 400 right away, also while a write is waiting
+        EMSESP::wait_validate(0x33);
+        EMSESP::webDataService.device_data(&request, 200);
+        errors += (EMSESP::webDataService.deferred_.size() != 0);
+        EMSESP::wait_validate(0);
+
+        shell.printfln("Test %s (%d errors)", errors == 0 ? "passed" : "FAILED", errors);
+        ok = true;
+    }
+
+    if (command == "ha_discovery") {
+        shell.printfln("Testing HA discovery in steps");
+        Mqtt::ha_enabled(true);
+
+        test("boiler");
+        test("thermostat");
+
+        // publishing the values flags the devices for discovery
+        EMSESP::publish_device_values(EMSdevice::DeviceType::BOILER);
+        EMSESP::publish_device_values(EMSdevice::DeviceType::THERMOSTAT);
+
+        uint16_t created, total;
+        EMSESP::ha_discovery_progress(created, total);
+        shell.printfln("HA discovery: %d of %d configs published", created, total);
+
+        // without a broker nothing is published, but each pending entity still uses up the budget once
+        // so the walk must finish in a fixed number of steps
+        uint8_t errors = 0;
+        for (const auto & emsdevice : EMSESP::emsdevices) {
+            uint16_t needed = 0, dummy = 0;
+            emsdevice->ha_config_count(dummy, needed);
+            if (!emsdevice->ha_config_pending()) {
+                shell.printfln("%s not pending", emsdevice->name());
+                errors++;
+                continue;
+            }
+            const uint8_t per_step = 4;
+            uint16_t      steps    = 0;
+            bool          done     = false;
+            while (!done && steps < 1000) {
+                uint8_t budget = per_step;
+                done           = emsdevice->mqtt_ha_entity_config_create(budget);
+                steps++;
+            }
+            // the last step may be one without anything left to do
+            uint16_t expected = needed / per_step + 1;
+            shell.printfln("%s: %d entities in %d steps", emsdevice->name(), needed, steps);
+            if (steps != expected || emsdevice->ha_config_pending()) {
+                errors++;
+            }
+        }
+
+        shell.printfln("Test %s (%d errors)", errors == 0 ? "passed" : "FAILED", errors);
+        ok = true;
+    }
+
+    if (command == "ha_config") {
+        shell.printfln("Testing HA discovery configs for all entities...");
+        Mqtt::ha_enabled(true);
+        System::test_set_all_active(true);
+
+        // every device in the library, as in dump_entities.csv
+        EMSESP::add_all_devices();
+        for (uint8_t device_type = 0; device_type < EMSdevice::DeviceType::UNKNOWN; device_type++) {
+            EMSESP::publish_device_values(device_type); // sets the entities active
+        }
+
+        uint16_t created, total;
+        EMSESP::ha_discovery_progress(created, total);
+
+        // without a broker the configs are built but not sent, so the devices can be walked again and again
+        // the main device config is only sent with the first entity, so leave it out like on a running system
+        for (const auto & emsdevice : EMSESP::emsdevices) {
+            emsdevice->ha_config_done(true);
+        }
+        const uint8_t passes = 5;
+        uint32_t      allocs = heap_allocations;
+        auto          start  = std::chrono::steady_clock::now();
+        for (uint8_t i = 0; i < passes; i++) {
+            for (const auto & emsdevice : EMSESP::emsdevices) {
+                uint8_t budget = 255;
+                while (!emsdevice->mqtt_ha_entity_config_create(budget)) {
+                    budget = 255;
+                }
+            }
+        }
+        auto us = std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - start).count();
+        allocs  = heap_allocations - allocs;
+
+        shell.printfln("Built %d configs for %d devices in %d us (%d us each), with %d heap allocations (%d each)",
+                       passes * total,
+                       EMSESP::emsdevices.size(),
+                       (uint32_t)us,
+                       (uint32_t)(us / (passes * total)),
+                       allocs,
+                       allocs / (passes * total));
+
+        System::test_set_all_active(false);
+        ok = true;
+    }
+
     if (command == "lastcode") {
         shell.printfln("Testing lastcode");
 
@@ -1651,6 +2714,57 @@ void Test::run_test(uuid::console::Shell & shell, const std::string & cmd, const
         ok = true;
     }
 
+    // count the bytes serialized per publish cycle, full payloads vs only the changed values
+    if (command == "mqtt_changed") {
+        shell.printfln("Testing MQTT publish of changed values...");
+
+        Mqtt::ha_enabled(false);
+        Mqtt::enabled(true);
+        Mqtt::publish_changed(true);
+        System::test_set_all_active(true); // fill all entities with values, like a busy system
+
+        add_device(0x08, 172); // Enviline/Compress 6000AW, lots of entities
+        add_device(0x10, 158); // RC310
+
+        const uint8_t cycles      = 10;
+        uint32_t      full_bytes  = 0;
+        uint32_t      delta_bytes = 0;
+        bool          ok_cycles   = true;
+
+        for (uint8_t cycle = 0; cycle <= cycles; cycle++) {
+            // a new UBAMonitorFast with a different flow temp, and the same RC310 HC1 status
+            uart_telegram({0x08, 0x00, 0x18, 0x00, 0x00, 0x02, (uint8_t)(0x5A + cycle), 0x73, 0x3D, 0x0A, 0x10, 0x65, 0x40, 0x02, 0x1A,
+                           0x80, 0x00, 0x01, 0xE1, 0x01, 0x76, 0x0E, 0x3D, 0x48, 0x00, 0xC9, 0x44, 0x02, 0x00});
+            uart_telegram("90 00 FF 00 01 A5 80 00 01 30 28 00 30 28 01 54 03 03 01 01 54 02 A8 00 00 11 01 03");
+
+            uint32_t full  = 0;
+            uint32_t delta = 0;
+            for (const auto & emsdevice : EMSESP::emsdevices) {
+                JsonDocument doc_delta;
+                emsdevice->generate_values(doc_delta.to<JsonObject>(), DeviceValueTAG::TAG_NONE, true, EMSdevice::OUTPUT_TARGET::MQTT, true);
+                delta += measureJson(doc_delta);
+                JsonDocument doc_full;
+                emsdevice->generate_values(doc_full.to<JsonObject>(), DeviceValueTAG::TAG_NONE, true, EMSdevice::OUTPUT_TARGET::MQTT);
+                full += measureJson(doc_full);
+            }
+
+            // the first cycle publishes everything, after that only the flow temp changes
+            if (cycle == 0) {
+                shell.printfln("Initial publish: %d bytes full, %d bytes changed", full, delta);
+                continue;
+            }
+            shell.printfln("Cycle %d: %d bytes full, %d bytes changed", cycle, full, delta);
+            ok_cycles &= (delta > 2 && delta < full);
+            full_bytes += full;
+            delta_bytes += delta;
+        }
+
+        uint32_t permille = full_bytes ? delta_bytes * 1000 / full_bytes : 0;
+        shell.printfln("Total: %d bytes full, %d bytes changed (%d.%d%%)", full_bytes, delta_bytes, permille / 10, permille % 10);
+        shell.printfln("Test %s", ok_cycles ? "passed" : "FAILED");
+        ok = true;
+    }
+
     if (command == "mqtt") {
         shell.printfln("Testing MQTT...");
 
@@ -1837,6 +2951,219 @@ void Test::run_test(uuid::console::Shell & shell, const std::string & cmd, const
     }
 }
 
+// the captured bus traffic, parsed into telegrams
+std::vector<std::shared_ptr<const Telegram>> Test::bus_capture() {
+    // parse the log into telegrams, same as the RxService does
+    std::vector<std::shared_ptr<const Telegram>> telegrams;
+    for (auto line : bus_log) {
+        uint8_t data[EMS_MAX_TELEGRAM_LENGTH];
+        uint8_t length = 0;
+        for (const char * p = line; *p; p += (p[2] ? 3 : 2)) {
+            data[length++] = (uint8_t)strtol(std::string(p, 2).c_str(), 0, 16);
+        }
+        if (data[2] != 0xFF || length < 5) {
+            telegrams.push_back(make_telegram(Telegram::Operation::RX, data[0], data[1], data[2], data[3], data + 4, length - 4));
+        } else {
+            telegrams.push_back(
+                make_telegram(Telegram::Operation::RX, data[0], data[1], (data[4] << 8) + data[5] + 256, data[3], data + 6, length - 6));
+        }
+    }
+    return telegrams;
+}
+
+#ifdef EMSESP_STANDALONE
+// replays a bus capture through EMSESP::incoming_telegram() and the RxService, like the UART does
+// the file is a binary capture from /rest/getCapture (see RxCapture) or text, where
+// each line of the file holds a frame as hex bytes including the CRC, optionally after a timestamp
+// in ms or as uptime (000+00:00:00.000), so the output of 'watch raw' can be used. Lines starting
+// with # are ignored, 'device <id> <product id>' adds a device before its telegrams are replayed.
+// Without a file the built-in capture is replayed 500 times.
+void Test::replay(uuid::console::Shell & shell, const std::string & filename, bool realtime) {
+    struct Frame {
+        uint32_t             timestamp;
+        std::vector<uint8_t> data;
+    };
+    std::vector<Frame> frames;
+
+    if (filename.empty()) {
+        add_device(0x08, 123); // GB072
+        add_device(0x10, 158); // RC310
+        add_device(0x18, 157); // CR100
+        add_device(0x30, 163); // SM100
+        for (uint16_t i = 0; i < 500; i++) {
+            for (auto line : bus_log) {
+                Frame frame{i * 1000U, {}};
+                for (const char * p = line; *p; p += (p[2] ? 3 : 2)) {
+                    frame.data.push_back((uint8_t)strtol(std::string(p, 2).c_str(), 0, 16));
+                }
+                frame.data.push_back(EMSESP::rxservice_.calculate_crc(frame.data.data(), frame.data.size()));
+                frames.push_back(std::move(frame));
+            }
+        }
+    } else {
+        std::ifstream file(filename, std::ios::binary);
+        if (!file) {
+            shell.printfln("Can't open %s", filename.c_str());
+            return;
+        }
+        std::string content((std::istreambuf_iterator<char>(file)), std::istreambuf_iterator<char>());
+
+        // a binary capture downloaded from /rest/getCapture
+        if (RxCapture::decode((const uint8_t *)content.data(), content.size(), [&](uint32_t uptime_ms, const uint8_t * data, uint8_t length) {
+                Frame frame{uptime_ms, std::vector<uint8_t>(data, data + length)};
+                frame.data.push_back(EMSESP::rxservice_.calculate_crc(data, length));
+                frames.push_back(std::move(frame));
+            })) {
+            content.clear();
+        }
+
+        std::istringstream lines(content);
+        std::string        line;
+        while (std::getline(lines, line)) {
+            std::istringstream       tokens(line);
+            std::vector<std::string> words;
+            std::string              word;
+            while (tokens >> word) {
+                words.push_back(word);
+            }
+            if (words.empty() || words[0][0] == '#') {
+                continue;
+            }
+            if (words[0] == "device" && words.size() == 3) {
+                add_device((uint8_t)strtol(words[1].c_str(), 0, 16), (uint8_t)strtol(words[2].c_str(), 0, 10));
+                continue;
+            }
+
+            // the frame is the run of hex bytes at the end of the line
+            size_t start = words.size();
+            while (start > 0 && words[start - 1].size() == 2 && isxdigit(words[start - 1][0]) && isxdigit(words[start - 1][1])) {
+                start--;
+            }
+            if (start == words.size() || words.size() - start > EMS_MAX_TELEGRAM_LENGTH) {
+                continue;
+            }
+
+            Frame frame{0, {}};
+            if (start) {
+                unsigned int days = 0, hours = 0, minutes = 0, seconds = 0, ms = 0;
+                if (sscanf(words[0].c_str(), "%u+%u:%u:%u.%u", &days, &hours, &minutes, &seconds, &ms) == 5) {
+                    frame.timestamp = (((days * 24 + hours) * 60 + minutes) * 60 + seconds) * 1000 + ms;
+                } else {
+                    frame.timestamp = strtoul(words[0].c_str(), nullptr, 10);
+                }
+            }
+            for (size_t i = start; i < words.size(); i++) {
+                frame.data.push_back((uint8_t)strtol(words[i].c_str(), 0, 16));
+            }
+            frames.push_back(std::move(frame));
+        }
+    }
+
+    if (frames.empty()) {
+        shell.printfln("Nothing to replay");
+        return;
+    }
+
+    // don't let the watch output take the time
+    EMSESP::watch(EMSESP::Watch::WATCH_OFF);
+
+    // handler latency per sending device, buckets up to 1, 5, 10, 50, 100 and above 100 us
+    static constexpr uint32_t BUCKETS[] = {1000, 5000, 10000, 50000, 100000};
+    struct Latency {
+        uint32_t count  = 0;
+        uint64_t total  = 0; // ns
+        uint32_t max    = 0; // ns
+        uint32_t bucket[sizeof(BUCKETS) / sizeof(BUCKETS[0]) + 1]{};
+    };
+    std::map<uint8_t, Latency> latencies;
+
+    shell.printfln("Replaying %d frames%s...", frames.size(), realtime ? " in real time" : "");
+
+    const uint32_t telegrams   = EMSESP::rxservice_.telegram_count();
+    const uint32_t crc_errors  = EMSESP::rxservice_.telegram_error_count();
+    uint32_t       allocations = 0;
+    uint64_t       busy_ns     = 0;
+    uint32_t       mqtt_bytes  = 0;
+    uint32_t       mqtt_count  = 0;
+
+    auto replay_start = std::chrono::steady_clock::now();
+    for (size_t i = 0; i < frames.size(); i++) {
+        auto & frame = frames[i];
+        if (realtime && i && frame.timestamp > frames[i - 1].timestamp) {
+            std::this_thread::sleep_for(std::chrono::milliseconds(frame.timestamp - frames[i - 1].timestamp));
+        }
+
+        uint32_t heap  = heap_allocations;
+        auto     start = std::chrono::steady_clock::now();
+        EMSESP::incoming_telegram(frame.data.data(), frame.data.size());
+        EMSESP::rxservice_.loop();
+        auto ns = std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - start).count();
+        busy_ns += ns;
+        allocations += heap_allocations - heap;
+
+        if (frame.data.size() > 1) {
+            auto & latency = latencies[frame.data[0] & 0x7F];
+            latency.count++;
+            latency.total += ns;
+            latency.max = std::max(latency.max, (uint32_t)ns);
+            uint8_t b   = 0;
+            while (b < sizeof(BUCKETS) / sizeof(BUCKETS[0]) && ns > BUCKETS[b]) {
+                b++;
+            }
+            latency.bucket[b]++;
+        }
+
+        // the payload a publish on change would send, outside of the timing
+        for (const auto & emsdevice : EMSESP::emsdevices) {
+            if (emsdevice->has_update()) {
+                JsonDocument doc;
+                emsdevice->generate_values(doc.to<JsonObject>(), DeviceValueTAG::TAG_NONE, true, EMSdevice::OUTPUT_TARGET::MQTT);
+                mqtt_bytes += measureJson(doc);
+                mqtt_count++;
+                emsdevice->has_update(false);
+            }
+        }
+    }
+    auto replay_us = std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - replay_start).count();
+
+    uint32_t processed = EMSESP::rxservice_.telegram_count() - telegrams;
+    shell.printfln("Processed %d telegrams (%d CRC errors) in %d ms, %d us busy",
+                   processed,
+                   EMSESP::rxservice_.telegram_error_count() - crc_errors,
+                   (uint32_t)(replay_us / 1000),
+                   (uint32_t)(busy_ns / 1000));
+    if (busy_ns) {
+        shell.printfln("Throughput: %d telegrams/sec", (uint32_t)(processed * 1000000000ULL / busy_ns));
+    }
+    shell.printfln("Heap allocations: %d (%d per telegram)", allocations, processed ? allocations / processed : 0);
+    shell.printfln("MQTT: %d publishes, %d bytes", mqtt_count, mqtt_bytes);
+
+    shell.printfln("Device            Count   Avg ns   Max ns   <1us   <5us  <10us  <50us <100us  >100us");
+    for (const auto & l : latencies) {
+        const char * name = "?";
+        for (const auto & emsdevice : EMSESP::emsdevices) {
+            if (emsdevice->is_device_id(l.first)) {
+                name = emsdevice->name();
+                break;
+            }
+        }
+        const auto & latency = l.second;
+        shell.printfln("0x%02X %-12.12s %6d %8d %8d %6d %6d %6d %6d %6d %7d",
+                       l.first,
+                       name,
+                       latency.count,
+                       (uint32_t)(latency.total / latency.count),
+                       latency.max,
+                       latency.bucket[0],
+                       latency.bucket[1],
+                       latency.bucket[2],
+                       latency.bucket[3],
+                       latency.bucket[4],
+                       latency.bucket[5]);
+    }
+}
+#endif
+
 // loop console. simulates what EMSESP::loop() does
 void Test::refresh() {
     uuid::loop();
@@ -74,6 +74,10 @@ class Test {
     static void add_device(uint8_t device_id, uint8_t product_id);
     static void refresh();
     static void listDir(fs::FS & fs, const char * dirname, uint8_t levels);
+    static std::vector<std::shared_ptr<const Telegram>> bus_capture();
+#ifdef EMSESP_STANDALONE
+    static void replay(uuid::console::Shell & shell, const std::string & filename = "", bool realtime = false);
+#endif
 };
 
 } // namespace emsesp
@@ -51,10 +51,12 @@ void EMSuart::uart_event_task(void * pvParameters) {
                 length += event.size;
             } else if (event.type == UART_BREAK) {
                 if (length == 2 || (length >= 6 && length <= EMS_MAXBUFFERSIZE)) {
+                    uint32_t break_us = Perf::now_us();
                     uart_read_bytes(EMSUART_NUM, telegram, length, portMAX_DELAY);
                     // if (telegram[0] && !telegram[length - 1]) {
                     EMSESP::incoming_telegram(telegram, (uint8_t)(length - 1));
                     // }
+                    Perf::add(Perf::UART, break_us);
                 } else {
                     // flush buffer up to break
                     uint8_t buf[length];
@@ -44,6 +44,10 @@ WebAPIService::WebAPIService(AsyncWebServer * server, SecurityManager * security
     server->on(GET_ENTITIES_PATH,
                HTTP_GET,
                securityManager->wrapRequest([this](AsyncWebServerRequest * request) { getEntities(request); }, AuthenticationPredicates::IS_ADMIN));
+
+    server->on(GET_CAPTURE_PATH,
+               HTTP_GET,
+               securityManager->wrapRequest([this](AsyncWebServerRequest * request) { getCapture(request); }, AuthenticationPredicates::IS_ADMIN));
 }
 
 // POST|GET /{device}
@@ -225,4 +229,27 @@ void WebAPIService::getEntities(AsyncWebServerRequest * request) {
     request->send(response);
 }
 
+// the bus capture as binary, see RxCapture. If it's not running the last saved capture is sent
+void WebAPIService::getCapture(AsyncWebServerRequest * request) {
+    auto & capture = EMSESP::rxservice_.capture();
+    if (!capture.active()) {
+#ifndef EMSESP_STANDALONE
+        if (LittleFS.exists(EMSESP_CAPTURE_FILE)) {
+            request->send(LittleFS, EMSESP_CAPTURE_FILE, "application/octet-stream", true);
+            return;
+        }
+#endif
+        request->send(404);
+        return;
+    }
+
+    // send a copy, the ring changes while the response goes out
+    auto snapshot = std::make_shared<std::vector<uint8_t>>(capture.snapshot());
+    request->send("application/octet-stream", snapshot->size(), [snapshot](uint8_t * buffer, size_t max_len, size_t index) -> size_t {
+        size_t len = std::min(max_len, snapshot->size() - index);
+        memcpy(buffer, snapshot->data() + index, len);
+        return len;
+    });
+}
+
 } // namespace emsesp
@@ -25,6 +25,7 @@
 #define GET_CUSTOMIZATIONS_PATH "/rest/getCustomizations"
 #define GET_SCHEDULE_PATH "/rest/getSchedule"
 #define GET_ENTITIES_PATH "/rest/getEntities"
+#define GET_CAPTURE_PATH "/rest/getCapture"
 
 namespace emsesp {
 
@@ -58,6 +59,7 @@ class WebAPIService {
     void getCustomizations(AsyncWebServerRequest * request);
     void getSchedule(AsyncWebServerRequest * request);
     void getEntities(AsyncWebServerRequest * request);
+    void getCapture(AsyncWebServerRequest * request);
 };
 
 } // namespace emsesp
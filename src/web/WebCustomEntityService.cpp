@@ -588,7 +588,7 @@ bool WebCustomEntityService::get_value(std::shared_ptr<const Telegram> telegram)
     for (auto & entity : *customEntityItems) {
         if (entity.value_type == DeviceValueType::STRING && telegram->type_id == entity.type_id && telegram->src == entity.device_id
             && telegram->offset <= entity.offset && (telegram->offset + telegram->message_length) >= (entity.offset + (uint8_t)entity.factor)) {
-            auto data = Helpers::data_to_hex(telegram->message_data, (uint8_t)entity.factor);
+            auto data = Helpers::data_to_hex(telegram->message_data + entity.offset - telegram->offset, (uint8_t)entity.factor);
             if (entity.data != data) {
                 entity.data = data;
                 if (Mqtt::publish_single()) {
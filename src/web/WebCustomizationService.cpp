@@ -130,6 +130,7 @@ StateUpdateResult WebCustomization::update(JsonObject root, WebCustomization & c
                 }
             }
 
+            emsEntity.build_index();
             customizations.entityCustomizations.push_back(emsEntity); // save the new object
         }
     }
@@ -137,6 +138,70 @@ StateUpdateResult WebCustomization::update(JsonObject root, WebCustomization & c
     return StateUpdateResult::CHANGED;
 }
 
+// FNV-1a hash of the entity shortname
+uint32_t EntityCustomization::name_hash(const char * name, size_t len) {
+    uint32_t hash = 2166136261UL;
+    while (len--) {
+        hash = (hash ^ (uint8_t)*name++) * 16777619UL;
+    }
+    return hash;
+}
+
+// length of the shortname, which follows the 2 mask characters and ends at the optional '|'
+uint8_t EntityCustomization::name_length(const std::string & entity_id) {
+    if (entity_id.size() < 2) {
+        return 0;
+    }
+    auto pos = entity_id.find('|', 2);
+    return std::min<size_t>((pos == std::string::npos ? entity_id.size() : pos) - 2, UINT8_MAX);
+}
+
+// the mask from the first 2 hex characters
+uint8_t EntityCustomization::entity_mask(const std::string & entity_id) {
+    char hex[3];
+    strlcpy(hex, entity_id.c_str(), sizeof(hex));
+    return Helpers::hextoint(hex);
+}
+
+void EntityCustomization::build_index() {
+    entity_index.clear();
+    entity_index.reserve(entity_ids.size());
+    for (uint16_t i = 0; i < entity_ids.size(); i++) {
+        uint8_t     len = name_length(entity_ids[i]);
+        EntityIndex entry{name_hash(entity_ids[i].c_str() + 2, len), i, entity_mask(entity_ids[i]), len};
+        // keep the order of entries with the same hash, so the first one added is found first
+        auto it = std::upper_bound(entity_index.begin(), entity_index.end(), entry, [](const EntityIndex & a, const EntityIndex & b) { return a.hash < b.hash; });
+        entity_index.insert(it, entry);
+    }
+}
+
+// appends an entity id and adds it to the index
+void EntityCustomization::add_entity(const std::string & entity_id) {
+    entity_ids.push_back(entity_id);
+    uint8_t     len = name_length(entity_id);
+    EntityIndex entry{name_hash(entity_id.c_str() + 2, len), (uint16_t)(entity_ids.size() - 1), entity_mask(entity_id), len};
+    auto it = std::upper_bound(entity_index.begin(), entity_index.end(), entry, [](const EntityIndex & a, const EntityIndex & b) { return a.hash < b.hash; });
+    entity_index.insert(it, entry);
+}
+
+// returns the entity with this shortname (including any tag prefix like hc1/), or nullptr if not customized
+const EntityCustomization::EntityIndex * EntityCustomization::find_entity(const char * shortname) const {
+    size_t   len  = strlen(shortname);
+    uint32_t hash = name_hash(shortname, len);
+    auto it = std::lower_bound(entity_index.begin(), entity_index.end(), hash, [](const EntityIndex & entry, const uint32_t h) { return entry.hash < h; });
+    for (; it != entity_index.end() && it->hash == hash; it++) {
+        if (it->name_len == len && !strncmp(entity_ids[it->pos].c_str() + 2, shortname, len)) {
+            return &(*it);
+        }
+    }
+    return nullptr;
+}
+
+const char * EntityCustomization::custom_name(const EntityIndex & entity) const {
+    const std::string & entity_id = entity_ids[entity.pos];
+    return (entity_id.size() > entity.name_len + 2u) ? entity_id.c_str() + entity.name_len + 3 : nullptr;
+}
+
 // deletes the customization file
 void WebCustomizationService::reset_customization(AsyncWebServerRequest * request) {
 #ifndef EMSESP_STANDALONE
@@ -225,9 +290,14 @@ void WebCustomizationService::customization_entities(AsyncWebServerRequest * req
                     uint8_t product_id = emsdevice->product_id();
                     uint8_t device_id  = emsdevice->device_id();
 
+                    // create a new entry for this device
+                    EntityCustomization new_entry;
+                    new_entry.product_id = product_id;
+                    new_entry.device_id  = device_id;
+
                     // and set the mask and custom names immediately for any listed entities
-                    JsonArray                entity_ids_json = json["entity_ids"];
-                    std::vector<std::string> entity_ids;
+                    JsonArray                  entity_ids_json = json["entity_ids"];
+                    std::vector<std::string> & entity_ids      = new_entry.entity_ids;
                     for (const JsonVariant id : entity_ids_json) {
                         std::string id_s = id.as<std::string>();
                         if (id_s[0] == '8') {
@@ -241,12 +311,11 @@ void WebCustomizationService::customization_entities(AsyncWebServerRequest * req
 
                     // add deleted entities from file
                     read([&](WebCustomization & settings) {
-                        for (EntityCustomization entityCustomization : settings.entityCustomizations) {
+                        for (const EntityCustomization & entityCustomization : settings.entityCustomizations) {
                             if (entityCustomization.device_id == device_id) {
-                                for (std::string entity_id : entityCustomization.entity_ids) {
-                                    uint8_t     mask = Helpers::hextoint(entity_id.substr(0, 2).c_str());
-                                    std::string name = DeviceValue::get_name(entity_id);
-                                    if (mask & 0x80) {
+                                for (const std::string & entity_id : entityCustomization.entity_ids) {
+                                    if (EntityCustomization::entity_mask(entity_id) & 0x80) {
+                                        std::string name = entity_id.substr(2, EntityCustomization::name_length(entity_id));
                                         bool is_set = false;
                                         for (const JsonVariant id : entity_ids_json) {
                                             std::string id_s = id.as<std::string>();
@@ -267,7 +336,8 @@ void WebCustomizationService::customization_entities(AsyncWebServerRequest * req
                     });
 
                     // get list of entities that have masks set or a custom fullname
-                    emsdevice->getCustomizationEntities(entity_ids);
+                    new_entry.build_index();
+                    emsdevice->getCustomizationEntities(new_entry);
 
                     // Save the list to the customization file
                     update([&](WebCustomization & settings) {
@@ -281,13 +351,6 @@ void WebCustomizationService::customization_entities(AsyncWebServerRequest * req
                             }
                         }
 
-                        // create a new entry for this device if there are values
-                        EntityCustomization new_entry;
-                        new_entry.product_id = product_id;
-                        new_entry.device_id  = device_id;
-
-                        new_entry.entity_ids = entity_ids;
-
                         // add the record and save
                         settings.entityCustomizations.push_back(new_entry);
                         return StateUpdateResult::CHANGED;
@@ -354,6 +417,7 @@ void WebCustomizationService::test() {
         emsEntity.product_id = 123;
         emsEntity.device_id  = 8;
         emsEntity.entity_ids.push_back("08heatingactive|is my heating on?");
+        emsEntity.build_index();
         webCustomization.entityCustomizations.push_back(emsEntity);
 
         return StateUpdateResult::CHANGED; // persist the changes
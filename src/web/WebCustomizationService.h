@@ -58,11 +58,30 @@ class AnalogCustomization {
 };
 
 // we use product_id and device_id to make the device unique
+// entity ids are in the form <XX><shortname>[|customname], with XX the mask in hex
 class EntityCustomization {
   public:
     uint8_t                  product_id; // device's product id
     uint8_t                  device_id;  // device's device id
     std::vector<std::string> entity_ids; // array of entity ids with masks and optional custom fullname
+
+    // entity_ids parsed once, sorted by the hash of the shortname. Rebuild with build_index() after changing entity_ids
+    struct EntityIndex {
+        uint32_t hash;
+        uint16_t pos;      // position in entity_ids
+        uint8_t  mask;     // mask flags
+        uint8_t  name_len; // length of the shortname
+    };
+    std::vector<EntityIndex> entity_index;
+
+    void                build_index();
+    void                add_entity(const std::string & entity_id);
+    const EntityIndex * find_entity(const char * shortname) const;
+    const char *        custom_name(const EntityIndex & entity) const; // nullptr if there is none
+
+    static uint32_t name_hash(const char * name, size_t len);
+    static uint8_t  name_length(const std::string & entity_id);
+    static uint8_t  entity_mask(const std::string & entity_id);
 };
 
 class WebCustomization {
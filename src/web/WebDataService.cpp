@@ -20,6 +20,8 @@
 
 namespace emsesp {
 
+std::mutex WebDataService::deferred_mutex_;
+
 WebDataService::WebDataService(AsyncWebServer * server, SecurityManager * securityManager)
 
 {
@@ -166,56 +168,142 @@ void WebDataService::sensor_data(AsyncWebServerRequest * request) {
 // The unique_id is the unique record ID from the Web table to identify which device to load
 // Compresses the JSON using MsgPack https://msgpack.org/index.html
 void WebDataService::device_data(AsyncWebServerRequest * request) {
-    uint8_t id;
     if (request->hasParam(F_(id))) {
-        id = Helpers::atoint(request->getParam(F_(id))->value().c_str()); // get id from url
+        uint8_t id = Helpers::atoint(request->getParam(F_(id))->value().c_str()); // get id from url
+        device_data(request, id);
+        return;
+    }
+
+    // invalid
+    AsyncWebServerResponse * response = request->beginResponse(400);
+    request->send(response);
+}
 
-        auto * response = new AsyncJsonResponse(false, true); // use msgPack
+// after a write the values are only valid once the validate telegram is received
+// instead of blocking the web server, a chunked response is sent that waits for the data built in loop()
+void WebDataService::device_data(AsyncWebServerRequest * request, uint8_t id) {
+    if (!EMSESP::wait_validate() || !has_device_values(id)) {
+        send_device_data(request, id); // or 400 for an unknown device, as without a write
+        return;
+    }
 
-        // check size
-        // while (!response) {
-        //     delete response;
-        //     buffer -= 1024;
-        //     response = new MsgpackAsyncJsonResponse(false, buffer);
-        // }
+    auto deferred   = std::make_shared<DeferredData>();
+    deferred->id    = id;
+    deferred->since = uuid::get_uptime();
+    {
+        std::lock_guard<std::mutex> lock{deferred_mutex_};
+        deferred_.push_back(deferred);
+    }
 
-        for (const auto & emsdevice : EMSESP::emsdevices) {
-            if (emsdevice->unique_id() == id) {
-                // wait max 2.5 sec for updated data (post_send_delay is 2 sec)
-                for (uint16_t i = 0; i < (emsesp::TxService::POST_SEND_DELAY + 500) && EMSESP::wait_validate(); i++) {
-                    delay(1);
-                }
-                EMSESP::wait_validate(0); // reset in case of timeout
-#ifndef EMSESP_STANDALONE
-                JsonObject output = response->getRoot();
-                emsdevice->generate_values_web(output);
-#endif
+    // called in the web server task until the data is there, also when the client is slow
+    // the status is already out with the first chunk, so if the device is gone meanwhile the connection is closed
+    request->sendChunked(JSON_MIMETYPE, [deferred, request](uint8_t * buffer, size_t max_len, size_t index) -> size_t {
+        std::lock_guard<std::mutex> lock{deferred_mutex_};
+        if (!deferred->ready) {
+            return RESPONSE_TRY_AGAIN;
+        }
+        if (deferred->failed) {
+            request->client()->close();
+            return 0;
+        }
+        if (index >= deferred->data.size()) {
+            return 0; // done
+        }
+        size_t len = std::min(max_len, deferred->data.size() - index);
+        memcpy(buffer, deferred->data.data() + index, len);
+        return len;
+    });
+}
+
+// build the data of the waiting device_data responses when the validate telegram has arrived or on timeout
+// the responses are sent by the web server task, the main loop never touches a request
+void WebDataService::loop() {
+    std::vector<std::shared_ptr<DeferredData>> pending;
+    {
+        std::lock_guard<std::mutex> lock{deferred_mutex_};
+        if (deferred_.empty()) {
+            return;
+        }
+        // wait max 2.5 sec for updated data (post_send_delay is 2 sec)
+        if (EMSESP::wait_validate() && (uuid::get_uptime() - deferred_.front()->since) < (TxService::POST_SEND_DELAY + 500)) {
+            return;
+        }
+        pending.swap(deferred_);
+    }
+
+    EMSESP::wait_validate(0); // reset in case of timeout
+    for (const auto & deferred : pending) {
+        JsonDocument doc;
+        std::string  data;
+        bool         found = device_values(doc.to<JsonObject>(), deferred->id);
+        serializeMsgPack(doc, data);
+
+        std::lock_guard<std::mutex> lock{deferred_mutex_};
+        deferred->data.swap(data);
+        deferred->failed = !found;
+        deferred->ready  = true;
+    }
+}
+
+void WebDataService::send_device_data(AsyncWebServerRequest * request, uint8_t id) {
+    auto * response = new AsyncJsonResponse(false, true); // use msgPack
+
+    // check size
+    // while (!response) {
+    //     delete response;
+    //     buffer -= 1024;
+    //     response = new MsgpackAsyncJsonResponse(false, buffer);
+    // }
 
+    if (device_values(response->getRoot(), id)) {
 #if defined(EMSESP_DEBUG)
-                size_t length = response->setLength();
-                EMSESP::logger().debug("Dashboard buffer used: %d", length);
+        size_t length = response->setLength();
+        EMSESP::logger().debug("Dashboard buffer used: %d", length);
 #else
-                response->setLength();
+        response->setLength();
 #endif
-                request->send(response);
-                return;
-            }
+        request->send(response);
+        return;
+    }
+
+    // invalid
+    delete response;
+    request->send(request->beginResponse(400));
+}
+
+// is there a device, or the custom entities with id 99, for the dashboard
+bool WebDataService::has_device_values(uint8_t id) {
+    for (const auto & emsdevice : EMSESP::emsdevices) {
+        if (emsdevice->unique_id() == id) {
+            return true;
         }
+    }
+#ifndef EMSESP_STANDALONE
+    return (id == 99);
+#else
+    return false;
+#endif
+}
 
+// the dashboard values of a device, or of the custom entities with id 99
+bool WebDataService::device_values(JsonObject output, uint8_t id) {
+    for (const auto & emsdevice : EMSESP::emsdevices) {
+        if (emsdevice->unique_id() == id) {
 #ifndef EMSESP_STANDALONE
-        if (id == 99) {
-            JsonObject output = response->getRoot();
-            EMSESP::webCustomEntityService.generate_value_web(output);
-            response->setLength();
-            request->send(response);
-            return;
-        }
+            emsdevice->generate_values_web(output);
 #endif
+            return true;
+        }
     }
 
-    // invalid
-    AsyncWebServerResponse * response = request->beginResponse(400);
-    request->send(response);
+#ifndef EMSESP_STANDALONE
+    if (id == 99) {
+        EMSESP::webCustomEntityService.generate_value_web(output);
+        return true;
+    }
+#endif
+
+    return false;
 }
 
 // assumes the service has been checked for admin authentication
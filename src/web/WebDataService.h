@@ -36,6 +36,8 @@ class WebDataService {
   public:
     WebDataService(AsyncWebServer * server, SecurityManager * securityManager);
 
+    void loop();
+
 // make all functions public so we can test in the debug and standalone mode
 #ifndef EMSESP_STANDALONE
   private:
@@ -45,12 +47,28 @@ class WebDataService {
     void core_data(AsyncWebServerRequest * request);
     void sensor_data(AsyncWebServerRequest * request);
     void device_data(AsyncWebServerRequest * request);
+    void device_data(AsyncWebServerRequest * request, uint8_t id);
+    void send_device_data(AsyncWebServerRequest * request, uint8_t id);
+    bool device_values(JsonObject output, uint8_t id);
+    bool has_device_values(uint8_t id);
 
     // POST
     void write_device_value(AsyncWebServerRequest * request, JsonVariant json);
     void write_temperature_sensor(AsyncWebServerRequest * request, JsonVariant json);
     void write_analog_sensor(AsyncWebServerRequest * request, JsonVariant json);
     void scan_devices(AsyncWebServerRequest * request); // command
+
+    // device_data responses waiting for the validate telegram of a write
+    // shared with the response filler, so a disconnect or a late loop() leaves nothing dangling
+    struct DeferredData {
+        uint8_t     id;
+        uint32_t    since;
+        bool        ready  = false;
+        bool        failed = false; // the device is gone
+        std::string data; // msgpack, set once by loop()
+    };
+    std::vector<std::shared_ptr<DeferredData>> deferred_;
+    static std::mutex deferred_mutex_; // the data is built in the main loop and read by the response in the web server task
 };
 
 } // namespace emsesp
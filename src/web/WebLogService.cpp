@@ -41,12 +41,13 @@ void WebLogService::begin() {
 void WebLogService::start() {
     EMSESP::webSettingsService.read([&](WebSettings & settings) {
         maximum_log_messages_ = settings.weblog_buffer;
-        limit_log_messages_   = maximum_log_messages_;
         compact_              = settings.weblog_compact;
-        uuid::log::Logger::register_handler(this, (uuid::log::Level)settings.weblog_level);
-        if ((uuid::log::Level)settings.weblog_level == uuid::log::Level::OFF) {
-            log_messages_.clear();
+        max_batch_            = settings.weblog_batch;
+        batch_bytes_          = settings.weblog_batch_bytes;
+        if ((uuid::log::Level)settings.weblog_level == uuid::log::Level::OFF || log_level() == uuid::log::Level::OFF) {
+            log_cursor_ = uuid::log::Logger::cursor_end();
         }
+        uuid::log::Logger::register_handler(this, (uuid::log::Level)settings.weblog_level);
     });
 }
 
@@ -59,14 +60,17 @@ void WebLogService::log_level(uuid::log::Level level) {
         settings.weblog_level = level;
         return StateUpdateResult::CHANGED;
     });
-    uuid::log::Logger::register_handler(this, level);
-    if (level == uuid::log::Level::OFF) {
-        log_messages_.clear();
+    // messages are filtered when they are read, skip the ones logged while switched off
+    if (level == uuid::log::Level::OFF || log_level() == uuid::log::Level::OFF) {
+        log_cursor_ = uuid::log::Logger::cursor_end();
     }
+    uuid::log::Logger::register_handler(this, level);
 }
 
+// messages in the shared log store that would be shown after a fetch, at the web log level
 size_t WebLogService::num_log_messages() const {
-    return log_messages_.size();
+    const uuid::log::Level level = log_level();
+    return uuid::log::Logger::pending(uuid::log::Logger::cursor_last(maximum_log_messages_, level), level);
 }
 
 size_t WebLogService::maximum_log_messages() const {
@@ -75,12 +79,6 @@ size_t WebLogService::maximum_log_messages() const {
 
 void WebLogService::maximum_log_messages(size_t count) {
     maximum_log_messages_ = std::max((size_t)1, count);
-    if (limit_log_messages_ > maximum_log_messages_) {
-        limit_log_messages_ = maximum_log_messages_;
-    }
-    while (log_messages_.size() > maximum_log_messages_) {
-        log_messages_.pop_front();
-    }
     EMSESP::webSettingsService.update([&](WebSettings & settings) {
         settings.weblog_buffer = count;
         return StateUpdateResult::CHANGED;
@@ -99,46 +97,33 @@ void WebLogService::compact(bool compact) {
     });
 }
 
-WebLogService::QueuedLogMessage::QueuedLogMessage(unsigned long id, std::shared_ptr<uuid::log::Message> && content)
-    : id_(id)
-    , content_(std::move(content)) {
+uint8_t WebLogService::max_batch() const {
+    return max_batch_;
 }
 
-void WebLogService::operator<<(std::shared_ptr<uuid::log::Message> message) {
-#ifndef EMSESP_STANDALONE
-    size_t maxAlloc = ESP.getMaxAllocHeap();
-    if (limit_log_messages_ > 5 && maxAlloc < 46080) {
-        --limit_log_messages_;
-    } else if (limit_log_messages_ < maximum_log_messages_ && maxAlloc > 51200) {
-        ++limit_log_messages_;
-    }
-#endif
-    while (log_messages_.size() >= limit_log_messages_) {
-        log_messages_.pop_front();
-    }
-
-    log_messages_.emplace_back(++log_message_id_, std::move(message));
+uint16_t WebLogService::batch_bytes() const {
+    return batch_bytes_;
+}
 
-    EMSESP::esp8266React.getNTPSettingsService()->read([&](NTPSettings & settings) {
-        if (!settings.enabled || (time(nullptr) < 1500000000L)) {
-            time_offset_ = 0;
-        } else {
-            uint32_t offset = time(nullptr) - uuid::get_uptime_sec();
-            // if NTP is more that 1 sec apart, correct setting
-            if (time_offset_ < offset - 1 || time_offset_ > offset + 1) {
-                time_offset_ = offset;
-            }
-        }
+void WebLogService::batch(uint8_t max_batch, uint16_t batch_bytes) {
+    max_batch_   = max_batch;
+    batch_bytes_ = batch_bytes;
+    EMSESP::webSettingsService.update([&](WebSettings & settings) {
+        settings.weblog_batch       = max_batch;
+        settings.weblog_batch_bytes = batch_bytes;
+        return StateUpdateResult::CHANGED;
     });
 }
 
 void WebLogService::loop() {
-    if (!events_.count() || log_messages_.empty()) {
+    if (!events_.count()) {
         return;
     }
 
     // see if we've advanced
-    if (log_messages_.back().id_ <= log_message_id_tail_) {
+    const uuid::log::Level level   = log_level();
+    const unsigned long    pending = uuid::log::Logger::pending(log_cursor_, level);
+    if (!pending) {
         return;
     }
 
@@ -148,13 +133,34 @@ void WebLogService::loop() {
     }
     last_transmit_ = uuid::get_uptime_ms();
 
-    // flush
-    for (const auto & message : log_messages_) {
-        if (message.id_ > log_message_id_tail_) {
-            log_message_id_tail_ = message.id_;
-            transmit(message);
-            return;
+    // skip the older messages if too many are waiting
+    if (pending > maximum_log_messages_) {
+        unsigned long dropped = log_cursor_.dropped;
+        log_cursor_           = uuid::log::Logger::cursor_last(maximum_log_messages_, level);
+        log_cursor_.dropped   = dropped;
+        dropped_ += pending - maximum_log_messages_;
+    }
+
+    EMSESP::esp8266React.getNTPSettingsService()->read([&](NTPSettings & settings) {
+        if (!settings.enabled || (time(nullptr) < 1500000000L)) {
+            time_offset_ = 0;
+        } else {
+            uint32_t offset = time(nullptr) - uuid::get_uptime_sec();
+            // if NTP is more that 1 sec apart, correct setting
+            if (time_offset_ < offset - 1 || time_offset_ > offset + 1) {
+                time_offset_ = offset;
+            }
         }
+    });
+
+    if (max_batch_) {
+        transmit_batch();
+        return;
+    }
+
+    uuid::log::Record message;
+    if (uuid::log::Logger::read(log_cursor_, level, message)) {
+        transmit(message);
     }
 }
 
@@ -171,32 +177,79 @@ char * WebLogService::messagetime(char * out, const uint64_t t, const size_t buf
     return out;
 }
 
-// send to web eventsource
-void WebLogService::transmit(const QueuedLogMessage & message) {
-    JsonDocument jsonDocument;
+void WebLogService::add_log_event(JsonObject logEvent, const uuid::log::Record & message) {
+    char time_string[25];
 
-    JsonObject logEvent = jsonDocument.to<JsonObject>();
-    char       time_string[25];
+    logEvent["t"] = messagetime(time_string, message.uptime_ms, sizeof(time_string));
+    logEvent["l"] = message.level;
+    logEvent["i"] = message.id;
+    logEvent["n"] = message.name;
+    logEvent["m"] = message.text;
+}
 
-    logEvent["t"] = messagetime(time_string, message.content_->uptime_ms, sizeof(time_string));
-    logEvent["l"] = message.content_->level;
-    logEvent["i"] = message.id_;
-    logEvent["n"] = message.content_->name;
-    logEvent["m"] = message.content_->text;
+// send to web eventsource
+void WebLogService::transmit(const uuid::log::Record & message) {
+    JsonDocument jsonDocument;
+    add_log_event(jsonDocument.to<JsonObject>(), message);
 
     size_t len    = measureJson(jsonDocument);
     char * buffer = new char[len + 1];
     if (buffer) {
         serializeJson(jsonDocument, buffer, len + 1);
-        events_.send(buffer, "message", message.id_);
+        events_.send(buffer, "message", message.id);
     }
     delete[] buffer;
 }
 
-// send the complete log buffer to the API, not filtering on log level
-// done by resetting the pointer
+// send all waiting messages as one event, limited by max_batch_ and batch_bytes_
+// {"e":[log entries], "d":messages dropped since the last event, "p":messages still waiting}
+void WebLogService::transmit_batch() {
+    JsonDocument jsonDocument;
+    JsonObject   root    = jsonDocument.to<JsonObject>();
+    JsonArray    entries = root["e"].to<JsonArray>();
+
+    const uuid::log::Level level   = log_level();
+    unsigned long          last_id = 0;
+    size_t                 bytes   = 0;
+    uuid::log::Record      message;
+    while (entries.size() < max_batch_) {
+        // only move on when the message fits in this event
+        uuid::log::Cursor next = log_cursor_;
+        if (!uuid::log::Logger::read(next, level, message)) {
+            log_cursor_ = next; // past the messages above the log level
+            break;
+        }
+        JsonObject logEvent = entries.add<JsonObject>();
+        add_log_event(logEvent, message);
+        bytes += measureJson(logEvent) + 1;
+        // always send at least one message, even if it's larger than the budget
+        if (bytes > batch_bytes_ && entries.size() > 1) {
+            entries.remove(entries.size() - 1);
+            break;
+        }
+        log_cursor_ = next;
+        last_id     = message.id;
+    }
+
+    if (!last_id) {
+        return;
+    }
+
+    root["d"]           = dropped_ + log_cursor_.dropped;
+    root["p"]           = uuid::log::Logger::pending(log_cursor_, level);
+    dropped_            = 0;
+    log_cursor_.dropped = 0;
+
+    transmit_buffer_.clear(); // keeps the capacity
+    serializeJson(jsonDocument, transmit_buffer_);
+    events_.send(transmit_buffer_.c_str(), "message", last_id);
+}
+
+// send the complete log buffer to the API
+// done by resetting the pointer to the last messages at the web log level
 void WebLogService::fetchLog(AsyncWebServerRequest * request) {
-    log_message_id_tail_ = 0;
+    log_cursor_ = uuid::log::Logger::cursor_last(maximum_log_messages_, log_level());
+    dropped_    = 0;
     request->send(200);
 }
 
@@ -209,6 +262,8 @@ void WebLogService::getSetValues(AsyncWebServerRequest * request, JsonVariant js
         root["level"]        = log_level();
         root["max_messages"] = maximum_log_messages();
         root["compact"]      = compact();
+        root["max_batch"]    = max_batch();
+        root["batch_bytes"]  = batch_bytes();
         response->setLength();
         request->send(response);
         return;
@@ -226,6 +281,9 @@ void WebLogService::getSetValues(AsyncWebServerRequest * request, JsonVariant js
     bool comp = body["compact"];
     compact(comp);
 
+    // optional, keep the current values if not given
+    batch(body["max_batch"] | max_batch(), body["batch_bytes"] | batch_bytes());
+
     request->send(200); // OK
 }
 
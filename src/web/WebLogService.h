@@ -41,37 +41,34 @@ class WebLogService : public uuid::log::Handler {
     void             maximum_log_messages(size_t count);
     bool             compact() const;
     void             compact(bool compact);
+    uint8_t          max_batch() const;
+    uint16_t         batch_bytes() const;
+    void             batch(uint8_t max_batch, uint16_t batch_bytes);
     void             loop();
 
-    virtual void operator<<(std::shared_ptr<uuid::log::Message> message);
-
+// make all functions public so we can test in the debug and standalone mode
+#ifndef EMSESP_STANDALONE
   private:
+#endif
     AsyncEventSource events_;
 
-    class QueuedLogMessage {
-      public:
-        QueuedLogMessage(unsigned long id, std::shared_ptr<uuid::log::Message> && content);
-        ~QueuedLogMessage() = default;
-
-        unsigned long                                   id_;      // Sequential identifier for this log message
-        struct timeval                                  time_;    // Time message was received
-        const std::shared_ptr<const uuid::log::Message> content_; // Log message content
-    };
-
-    void transmit(const QueuedLogMessage & message);
+    void transmit(const uuid::log::Record & message);
+    void transmit_batch();
+    void add_log_event(JsonObject logEvent, const uuid::log::Record & message);
     void fetchLog(AsyncWebServerRequest * request);
     void getSetValues(AsyncWebServerRequest * request, JsonVariant json);
 
     char * messagetime(char * out, const uint64_t t, const size_t bufsize);
 
-    uint64_t                     last_transmit_        = 0;                // Last transmit time
-    size_t                       maximum_log_messages_ = MAX_LOG_MESSAGES; // Maximum number of log messages to buffer before they are output
-    size_t                       limit_log_messages_   = 1;                // dynamic limit
-    unsigned long                log_message_id_       = 0;                // The next identifier to use for queued log messages
-    unsigned long                log_message_id_tail_  = 0;                // last event shown on the screen after fetch
-    std::deque<QueuedLogMessage> log_messages_;                            // Queued log messages, in the order they were received
-    time_t                       time_offset_ = 0;
-    bool                         compact_     = true;
+    uint64_t          last_transmit_        = 0;                // Last transmit time
+    size_t            maximum_log_messages_ = MAX_LOG_MESSAGES; // Maximum number of log messages to buffer before they are output
+    uuid::log::Cursor log_cursor_;                              // Read position in the log message store, reset on fetch
+    time_t            time_offset_ = 0;
+    bool              compact_     = true;
+    uint8_t           max_batch_   = 20;   // max messages per event, 0 sends each message as its own event
+    uint16_t          batch_bytes_ = 2048; // max size of the log entries in one event
+    unsigned long     dropped_     = 0;    // messages skipped because more than maximum_log_messages_ were waiting
+    std::string       transmit_buffer_;    // reused for each batch
 };
 
 } // namespace emsesp
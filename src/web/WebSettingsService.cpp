@@ -68,6 +68,11 @@ void WebSettings::read(WebSettings & settings, JsonObject root) {
     root["weblog_level"]          = settings.weblog_level;
     root["weblog_buffer"]         = settings.weblog_buffer;
     root["weblog_compact"]        = settings.weblog_compact;
+    root["weblog_batch"]          = settings.weblog_batch;
+    root["weblog_batch_bytes"]    = settings.weblog_batch_bytes;
+    root["fetch_min"]             = settings.fetch_min;
+    root["fetch_max"]             = settings.fetch_max;
+    root["tx_share"]              = settings.tx_share;
     root["phy_type"]              = settings.phy_type;
     root["eth_power"]             = settings.eth_power;
     root["eth_phy_addr"]          = settings.eth_phy_addr;
@@ -297,9 +302,18 @@ StateUpdateResult WebSettings::update(JsonObject root, WebSettings & settings) {
     settings.bool_dashboard = root["bool_dashboard"] | EMSESP_DEFAULT_BOOL_FORMAT;
     EMSESP::system_.bool_dashboard(settings.bool_dashboard);
 
-    settings.weblog_level   = root["weblog_level"] | EMSESP_DEFAULT_WEBLOG_LEVEL;
-    settings.weblog_buffer  = root["weblog_buffer"] | EMSESP_DEFAULT_WEBLOG_BUFFER;
-    settings.weblog_compact = root["weblog_compact"] | EMSESP_DEFAULT_WEBLOG_COMPACT;
+    settings.weblog_level       = root["weblog_level"] | EMSESP_DEFAULT_WEBLOG_LEVEL;
+    settings.weblog_buffer      = root["weblog_buffer"] | EMSESP_DEFAULT_WEBLOG_BUFFER;
+    settings.weblog_compact     = root["weblog_compact"] | EMSESP_DEFAULT_WEBLOG_COMPACT;
+    settings.weblog_batch       = root["weblog_batch"] | EMSESP_DEFAULT_WEBLOG_BATCH;
+    settings.weblog_batch_bytes = root["weblog_batch_bytes"] | EMSESP_DEFAULT_WEBLOG_BATCH_BYTES;
+
+    settings.fetch_min = root["fetch_min"] | EMSESP_DEFAULT_FETCH_MIN;
+    settings.fetch_max = root["fetch_max"] | EMSESP_DEFAULT_FETCH_MAX;
+    EMSdevice::fetch_intervals(settings.fetch_min, settings.fetch_max);
+
+    settings.tx_share = root["tx_share"] | EMSESP_DEFAULT_TX_SHARE;
+    EMSESP::txservice_.pacer().share(settings.tx_share);
 
     // save the settings
     if (flags_ == WebSettings::ChangeFlags::RESTART) {
@@ -64,6 +64,11 @@ class WebSettings {
     int8_t   weblog_level;
     uint8_t  weblog_buffer;
     bool     weblog_compact;
+    uint8_t  weblog_batch;
+    uint16_t weblog_batch_bytes;
+    uint8_t  fetch_min;
+    uint8_t  fetch_max;
+    uint8_t  tx_share;
     bool     fahrenheit;
 
     uint8_t phy_type;